@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    AdditiveOscillator.cpp
+    Created: 17 Oct 2026 10:12:48am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "AdditiveOscillator.h"
+#include "WavetableGenerator.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+
+AdditiveOscillator::AdditiveOscillator(float sampleRate) : sampleRate{ sampleRate }
+{
+    // The spectra are calculated here rather than on the audio thread
+    getSpectra();
+}
+
+void AdditiveOscillator::setSampleRate(float newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+void AdditiveOscillator::setPhase(uint32_t newPhase)
+{
+    phase = newPhase;
+}
+
+uint32_t AdditiveOscillator::getPhase() const
+{
+    return phase;
+}
+
+void AdditiveOscillator::setFrequency(float frequency)
+{
+    // Same as WavetableOscillator::setFrequency(), so every engine plays exactly the same pitch
+    phaseIncrement = static_cast<uint32_t>(static_cast<int64_t>(static_cast<double>(frequency) / sampleRate * 4294967296.0));
+}
+
+void AdditiveOscillator::setMorph(float morph)
+{
+    // Same morph positions as the frames of WavetableOscillator
+    const float framePosition = std::clamp(morph, 0.0f, 1.0f) / constants::MORPH_FRAME_WIDTH;
+    morphFrame = std::min(static_cast<int>(framePosition), WavetableBank::numShapes - 2);
+    nextMorphFrameWeight = framePosition - static_cast<float>(morphFrame);
+}
+
+void AdditiveOscillator::setPartials(int maxPartials, const float* partialGains)
+{
+    partialsLimit = std::clamp(maxPartials, 1, constants::MAX_PARTIALS);
+    gains = partialGains;
+}
+
+void AdditiveOscillator::renderBlock(const SimdKernels& kernels, Partials& partials, float* out, int numSamples)
+{
+    const Spectra& spectra = getSpectra();
+    const auto& spectrum = spectra[morphFrame];
+    const auto& nextSpectrum = spectra[morphFrame + 1];
+    
+    // Partial n is at n times the frequency; the ones at or above Nyquist (half a period per sample) are left out
+    const int audiblePartials = phaseIncrement == 0 ? 0 : static_cast<int>(std::min<uint32_t>(0x7FFFFFFFu / phaseIncrement,
+                                                                                                static_cast<uint32_t>(partialsLimit)));
+    
+    /*
+     The partials start from the phase at every block, so they never drift from it: the phase of partial n and its
+     increment are the ones of the fundamental turned n times, with complex multiplications in double precision.
+     LRN a point on the unit circle at angle a is (cos a, sin a); multiplying it by the point at angle b (as complex
+     numbers) gives the point at angle a + b, so a sine is rendered by turning a point by the same angle every sample
+     */
+    constexpr double phaseToRadians { 2.0 * 3.14159265358979323846 / 4294967296.0 };
+    const double phaseAngle = static_cast<double>(phase) * phaseToRadians;
+    const double incrementAngle = static_cast<double>(phaseIncrement) * phaseToRadians;
+    const double phaseCos = std::cos(phaseAngle), phaseSin = std::sin(phaseAngle);
+    const double incrementCos = std::cos(incrementAngle), incrementSin = std::sin(incrementAngle);
+    double partialCos = phaseCos, partialSin = phaseSin;
+    double rotationCos = incrementCos, rotationSin = incrementSin;
+    int count = 0;
+    
+    for (int n = 1; n <= audiblePartials; ++n) {
+        float amplitude = spectrum[n] + (nextSpectrum[n] - spectrum[n]) * nextMorphFrameWeight;
+        
+        if (gains != nullptr) {
+            amplitude *= gains[n - 1];
+        }
+        
+        // Silent partials (the even harmonics of the triangle and square) cost nothing
+        if (amplitude != 0.0f) {
+            partials.sines[count] = static_cast<float>(partialSin);
+            partials.cosines[count] = static_cast<float>(partialCos);
+            partials.rotationSines[count] = static_cast<float>(rotationSin);
+            partials.rotationCosines[count] = static_cast<float>(rotationCos);
+            partials.amplitudes[count] = amplitude;
+            ++count;
+        }
+        
+        const double nextCos = partialCos * phaseCos - partialSin * phaseSin;
+        partialSin = partialSin * phaseCos + partialCos * phaseSin;
+        partialCos = nextCos;
+        
+        const double nextRotationCos = rotationCos * incrementCos - rotationSin * incrementSin;
+        rotationSin = rotationSin * incrementCos + rotationCos * incrementSin;
+        rotationCos = nextRotationCos;
+    }
+    
+    // The kernels render whole vectors of partials; the last one is completed with silent ones
+    for (; count % kernels.width != 0; ++count) {
+        partials.sines[count] = 0.0f;
+        partials.cosines[count] = 1.0f;
+        partials.rotationSines[count] = 0.0f;
+        partials.rotationCosines[count] = 1.0f;
+        partials.amplitudes[count] = 0.0f;
+    }
+    
+    partials.count = count;
+    kernels.renderPartials(partials, out, numSamples);
+    
+    phase += static_cast<uint32_t>(numSamples) * phaseIncrement;
+}
+
+void AdditiveOscillator::stop(bool phaseRand)
+{
+    // Starting phase of the oscillator will be randomized on the next note if phaseRand is activated, at the same
+    //  positions as WavetableOscillator
+    phase = (phaseRand ? static_cast<uint32_t>(rand() % constants::WAVETABLE_LENGTH) << (32 - constants::WAVETABLE_LENGTH_BITS) : 0u);
+    phaseIncrement = 0;
+}
+
+bool AdditiveOscillator::isPlaying()
+{
+    return phaseIncrement != 0;
+}
+
+const AdditiveOscillator::Spectra& AdditiveOscillator::getSpectra()
+{
+    // LRN a static local variable is initialized once, on the first call, even with several threads
+    static const Spectra spectra = [] {
+        Spectra result {};
+        const std::vector<float> shapeHarmonics[WavetableBank::numShapes] {
+            WavetableGenerator::getSineHarmonics(),
+            WavetableGenerator::getTriangleHarmonics(constants::MAX_PARTIALS),
+            WavetableGenerator::getSquareHarmonics(constants::MAX_PARTIALS),
+            WavetableGenerator::getSawtoothHarmonics(constants::MAX_PARTIALS)
+        };
+        
+        for (int shape = 0; shape < WavetableBank::numShapes; ++shape) {
+            std::copy(shapeHarmonics[shape].begin(), shapeHarmonics[shape].end(), result[shape].begin());
+        }
+        
+        return result;
+    }();
+    
+    return spectra;
+}
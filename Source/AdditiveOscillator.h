@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    AdditiveOscillator.h
+    Created: 17 Oct 2026 10:12:48am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include "Constants.h"
+#include "WavetableBank.h"
+
+class SimdKernels;
+
+/**
+ This class represents an oscillator that adds up to constants::MAX_PARTIALS sines (partials), one per harmonic,
+ with the amplitudes of the harmonics of the morph's shapes (from WavetableGenerator) times a gain per partial.
+ Every sine is a recursive oscillator: a rotation of its (sine, cosine) pair by its phase increment at every sample,
+ rendered by the SIMD kernels with one partial per lane. The partials above Nyquist and the silent ones are left
+ out, so the cost follows the number of partials heard; the timbre changes with the gains, at no cost and without
+ new tables.
+ It plays the same shapes, with the same phase and morph, as WavetableOscillator, and has the same interface; the
+ triangle has all its harmonics (the tables only have constants::TRIANGLE_MAX_HARMONIC).
+ */
+class AdditiveOscillator
+{
+public:
+    float initFrequency = 0; // Original frequency before modulation
+    
+    /**
+     The partials of an oscillator for one block, in the order the SIMD kernels render them: the sine and cosine of
+     every partial at the first sample, the sine and cosine of its phase increment, and its amplitude. count is a
+     multiple of the kernels' width; the partials past the playing ones have no amplitude.
+     */
+    struct Partials
+    {
+        alignas(64) std::array<float, constants::MAX_PARTIALS> sines;
+        alignas(64) std::array<float, constants::MAX_PARTIALS> cosines;
+        alignas(64) std::array<float, constants::MAX_PARTIALS> rotationSines;
+        alignas(64) std::array<float, constants::MAX_PARTIALS> rotationCosines;
+        alignas(64) std::array<float, constants::MAX_PARTIALS> amplitudes;
+        int count;
+    };
+    
+    AdditiveOscillator(float sampleRate);
+    
+    /**
+     Changes the sample rate. The frequency must be set again after this.
+     */
+    void setSampleRate(float newSampleRate);
+    
+    /**
+     Moves the phase to a position in the period, in 32-bit fixed point (2^32 is a full period).
+     */
+    void setPhase(uint32_t newPhase);
+    
+    /**
+     Returns the position in the period, in 32-bit fixed point.
+     */
+    uint32_t getPhase() const;
+    
+    /**
+     Calculates the phaseIncrement according to the desired frequency in Hz.
+     */
+    void setFrequency(float frequency);
+    
+    /**
+     Sets the morph position, between 0 (sine) and 1 (saw).
+     */
+    void setMorph(float morph);
+    
+    /**
+     Sets the partials played: at most maxPartials (from 1 to constants::MAX_PARTIALS), each multiplied by its gain
+     in partialGains (element 0 is the fundamental), which must stay alive while it is used; nullptr plays the
+     shapes as they are.
+     */
+    void setPartials(int maxPartials, const float* partialGains);
+    
+    /**
+     Renders the next numSamples samples of the oscillator in out with the kernels; partials is the working space
+     of the kernels, shared by the oscillators rendered one after the other.
+     */
+    void renderBlock(const SimdKernels& kernels, Partials& partials, float* out, int numSamples);
+    
+    /**
+     Stops playback and resets phase/phase increment. The starting phase can be randomized.
+     */
+    void stop(bool phaseRand);
+    
+    /**
+     Returns true if the oscillator is playing.
+     */
+    bool isPlaying();
+    
+private:
+    float sampleRate;
+    
+    // Same fixed-point phase as WavetableOscillator
+    uint32_t phase = 0;
+    uint32_t phaseIncrement = 0;
+    
+    int morphFrame = 0; // shape before the morph position
+    float nextMorphFrameWeight = 0.0f; // position between morphFrame and the next shape
+    
+    int partialsLimit = constants::MAX_PARTIALS;
+    const float* gains = nullptr;
+    
+    // Amplitude of every partial of every shape, in the order of WavetableBank::Shape; element n is partial n
+    using Spectra = std::array<std::array<float, constants::MAX_PARTIALS + 1>, WavetableBank::numShapes>;
+    
+    /**
+     Returns the spectra of the shapes, calculated on the first call.
+     */
+    static const Spectra& getSpectra();
+};
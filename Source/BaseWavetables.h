@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    BaseWavetables.h
+    Created: 7 Oct 2026 11:20:05am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include "Constants.h"
+
+/**
+ This namespace contains the wavetables that never change (the sine, and the triangle with all its harmonics).
+ They are computed by the compiler and linked read-only into the binary, so every plugin instance of a process
+ reads the same memory pages and no math is done when the plugin is loaded.
+ This header is heavy to compile; only include it where the tables are used.
+ */
+namespace baseWavetables
+{
+    using Table = std::array<float, constants::WAVETABLE_STRIDE>;
+
+    /**
+     Copies the first samples of a table after its end (the guard samples).
+     */
+    constexpr void addGuardSamples(Table& table)
+    {
+        for (int i = 0; i < constants::WAVETABLE_GUARD_SAMPLES; ++i) {
+            table[constants::WAVETABLE_LENGTH + i] = table[i];
+        }
+    }
+
+    /**
+     Compile-time sine of x, for x in [-pi/2, pi/2], using its Taylor series.
+     */
+    constexpr double taylorSine(double x)
+    {
+        double term = x;
+        double sum = x;
+
+        // Terms get smaller than the double's precision long before the 15th one
+        for (int n = 1; n < 15; ++n) {
+            term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    /**
+     Builds a sine table, with its guard samples. Only the first quarter of the period is computed; the rest is obtained by symmetry.
+     */
+    constexpr Table makeSineTable()
+    {
+        constexpr int quarter = constants::WAVETABLE_LENGTH / 4;
+        constexpr double twoPi = 6.283185307179586476925;
+
+        Table table {};
+
+        for (int i = 0; i <= quarter; ++i) {
+            const float value = static_cast<float>(taylorSine(twoPi * i / constants::WAVETABLE_LENGTH));
+
+            table[i] = value; // rising first quarter
+            table[2 * quarter - i] = value; // falling second quarter
+
+            // Both negative quarters (skip the zero crossings at half and full period)
+            if (i > 0) {
+                table[2 * quarter + i] = -value;
+            }
+            if (i > 0 && i < quarter) {
+                table[constants::WAVETABLE_LENGTH - i] = -value;
+            }
+        }
+
+        addGuardSamples(table);
+        return table;
+    }
+
+    /**
+     Builds a triangle table, with its guard samples, with every odd harmonic up to constants::TRIANGLE_MAX_HARMONIC.
+     The sine of harmonic n at index i is the sine table at index n * i (wrapped around), so no more trigonometry
+     is needed.
+     */
+    constexpr Table makeTriangleTable(const Table& sine)
+    {
+        constexpr double pi = 3.141592653589793238463;
+
+        Table table {};
+
+        for (int i = 0; i < constants::WAVETABLE_LENGTH; ++i) {
+            double sum = 0.0;
+
+            // Odd harmonics only, with alternating signs and 1/n^2 amplitudes
+            for (int n = 1; n <= constants::TRIANGLE_MAX_HARMONIC; n += 2) {
+                const double sign = ((n / 2) % 2 == 0) ? -1.0 : 1.0;
+                sum += 8.0 / (pi * pi) * sign / (n * n) * sine[(n * i) % constants::WAVETABLE_LENGTH];
+            }
+
+            table[i] = static_cast<float>(sum);
+        }
+
+        addGuardSamples(table);
+        return table;
+    }
+
+    // LRN constexpr variables are computed when compiling, and stored in the read-only data of the binary
+    inline constexpr Table sine = makeSineTable();
+    inline constexpr Table triangle = makeTriangleTable(sine);
+}
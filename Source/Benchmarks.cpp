@@ -0,0 +1,842 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Created: 11 Oct 2026 2:15:37pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "AdditiveOscillator.h"
+#include "Constants.h"
+#include "Envelope.h"
+#include "LowPassFilter.h"
+#include "PolyBlepOscillator.h"
+#include "SimdKernels.h"
+#include "Synth.h"
+#include "WavetableBank.h"
+#include "WavetableCache.h"
+#include "WavetableFormats.h"
+#include "WavetableGenerator.h"
+#include "WavetableOscillator.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    /**
+     Encodes and decodes every table in a format, and logs the resulting SNR over all the tables and for the
+     worst one.
+     */
+    template <typename Format>
+    void reportFormat(const std::vector<std::vector<float>>& tables)
+    {
+        std::vector<typename Format::Sample> encoded(constants::WAVETABLE_LENGTH);
+        std::vector<float> decoded(constants::WAVETABLE_LENGTH);
+
+        double totalSignal = 0.0;
+        double totalNoise = 0.0;
+        double worstSnr = std::numeric_limits<double>::max();
+
+        for (const auto& table : tables) {
+            for (int i = 0; i < constants::WAVETABLE_LENGTH; ++i) {
+                encoded[i] = Format::encode(table[i]);
+            }
+
+            Format::decode(encoded.data(), decoded.data(), constants::WAVETABLE_LENGTH);
+
+            double signal = 0.0;
+            double noise = 0.0;
+
+            for (int i = 0; i < constants::WAVETABLE_LENGTH; ++i) {
+                const double error = static_cast<double>(decoded[i]) - table[i];
+                signal += static_cast<double>(table[i]) * table[i];
+                noise += error * error;
+            }
+
+            totalSignal += signal;
+            totalNoise += noise;
+
+            if (noise > 0.0) {
+                worstSnr = std::min(worstSnr, 10.0 * std::log10(signal / noise));
+            }
+        }
+
+        const size_t bytes = tables.size() * constants::WAVETABLE_LENGTH * sizeof(typename Format::Sample);
+        juce::String snr = "lossless";
+
+        if (totalNoise > 0.0) {
+            snr = "SNR " + juce::String(10.0 * std::log10(totalSignal / totalNoise), 1) + " dB (worst table "
+                + juce::String(worstSnr, 1) + " dB)";
+        }
+
+        juce::Logger::writeToLog(juce::String("Wavetable format ") + Format::name + ": " + snr + ", "
+                                 + juce::String(static_cast<int>(bytes / 1024)) + " KB for "
+                                 + juce::String(static_cast<int>(tables.size())) + " tables");
+    }
+    
+    /**
+     Voices' oscillators, envelopes and filters, rendered by a set of SIMD kernels like the synth does. Notes start and
+     stop at fixed chunks, and the filters sweep, so every set of kernels renders exactly the same thing.
+     */
+    struct KernelsFixture
+    {
+        static constexpr int voicesCount { constants::DEFAULT_POLYPHONY };
+        static constexpr int kernelsCount { 4 };
+        static constexpr int chunkSize { constants::LOWER_UPDATE_RATE_MAX_VALUE };
+        
+        // Lanes (or voices, for mixing) rendered per call of each kernel
+        static constexpr std::array<int, kernelsCount> lanesCounts { 2 * voicesCount, voicesCount, voicesCount, voicesCount };
+        
+        using Buffer = std::array<float, chunkSize>;
+        
+        std::vector<WavetableOscillator> oscillators;
+        std::vector<WavetableOscillator> blockOscillators; // the same, rendered by WavetableOscillator::renderBlock()
+        Envelope::States envelopeStates;
+        StateVariableFilter::States filterStates;
+        std::vector<Envelope> envelopes;
+        std::vector<LowPassFilter> filters;
+        std::vector<float> filterQs;
+        std::array<Buffer, 2 * voicesCount> oscOutputs {};
+        std::array<Buffer, 2 * voicesCount> blockOutputs {};
+        std::array<Buffer, constants::VOICE_SLOTS> envOutputs {};
+        std::array<Buffer, voicesCount> filterOutputs {};
+        std::array<Buffer, voicesCount> mixOutputs {};
+        std::array<Buffer, voicesCount> mixRightOutputs {};
+        std::array<int, voicesCount> activeSamples {};
+        std::array<int, voicesCount> filterSamples {};
+        Buffer noise {};
+        Buffer output {};
+        
+        KernelsFixture(const WavetableBank& bank, float sampleRate)
+        {
+            juce::Random random(1234);
+            
+            for (int o = 0; o < 2 * voicesCount; ++o) {
+                const int note = 24 + random.nextInt(72);
+                const float frequency = static_cast<float>(juce::MidiMessage::getMidiNoteInHertz(note));
+                
+                oscillators.emplace_back(&bank.getMorphFrames(WavetableBank::getLevelForFrequency(frequency)), sampleRate);
+                oscillators.back().setFrequency(frequency);
+                oscillators.back().setMorph(random.nextFloat());
+            }
+            
+            blockOscillators = oscillators;
+            
+            for (int v = 0; v < voicesCount; ++v) {
+                Envelope envelope;
+                envelope.bind(envelopeStates, v);
+                envelope.reset();
+                envelope.attackMultiplier = std::exp(-1.0f / (sampleRate * (0.001f + 0.05f * random.nextFloat())));
+                envelope.decayMultiplier = std::exp(-1.0f / (sampleRate * (0.01f + 0.2f * random.nextFloat())));
+                envelope.sustainLevel = 0.2f + 0.7f * random.nextFloat();
+                envelope.releaseMultiplier = std::exp(-1.0f / (sampleRate * (0.02f + 0.3f * random.nextFloat())));
+                envelopes.push_back(envelope);
+                
+                LowPassFilter filter;
+                filter.bind(filterStates, v);
+                filter.sampleRate = sampleRate;
+                filter.reset();
+                filters.push_back(filter);
+                filterQs.push_back(0.707f + 4.0f * random.nextFloat());
+            }
+            
+            for (int i = 0; i < chunkSize; ++i) {
+                noise[i] = 0.05f * (2.0f * random.nextFloat() - 1.0f);
+            }
+        }
+        
+        /**
+         Renders one chunk with kernels, adding the time spent in each kernel to times (in ms).
+         */
+        void renderChunk(const SimdKernels& kernels, int chunk, std::array<double, kernelsCount>& times)
+        {
+            std::array<WavetableOscillator::Lane, 2 * voicesCount> oscLanes;
+            
+            for (int v = 0; v < voicesCount; ++v) {
+                // Every voice plays a note for 200 chunks, then releases it for 200 chunks
+                const int position = (chunk + 37 * v) % 400;
+                
+                if (position == 0) {
+                    envelopes[v].attack();
+                }
+                else if (position == 200) {
+                    envelopes[v].release();
+                }
+                
+                const float cutoff = 200.0f * std::pow(2.0f, 3.0f + 3.0f * std::sin(0.01f * static_cast<float>(chunk) + static_cast<float>(v)));
+                filters[v].updateCoefficiants(cutoff, filterQs[v]);
+            }
+            
+            double start = juce::Time::getMillisecondCounterHiRes();
+            
+            for (int o = 0; o < 2 * voicesCount; ++o) {
+                oscillators[o].prepareLane(oscLanes[o], oscOutputs[o].data());
+            }
+            
+            kernels.renderOscillators(oscLanes.data(), 2 * voicesCount, chunkSize, interpolation::linear);
+            
+            for (int o = 0; o < 2 * voicesCount; ++o) {
+                oscillators[o].finishLane(oscLanes[o]);
+            }
+            
+            double end = juce::Time::getMillisecondCounterHiRes();
+            times[0] += end - start;
+            
+            // The oscillators as they were rendered before the kernels, which is not timed
+            for (int o = 0; o < 2 * voicesCount; ++o) {
+                blockOscillators[o].renderBlock(blockOutputs[o].data(), chunkSize, interpolation::linear);
+            }
+            
+            start = juce::Time::getMillisecondCounterHiRes();
+            
+            kernels.renderEnvelopes(envelopeStates, 0, voicesCount, envOutputs[0].data(), chunkSize, chunkSize);
+            
+            for (int v = 0; v < voicesCount; ++v) {
+                activeSamples[v] = envelopes[v].getActiveSamples();
+            }
+            
+            end = juce::Time::getMillisecondCounterHiRes();
+            times[1] += end - start;
+            start = end;
+            
+            // Some lanes are shorter, like voices stopping in the chunk
+            for (int v = 0; v < voicesCount; ++v) {
+                filterSamples[v] = chunkSize - v % 4;
+                filters[v].prepareBlock(oscOutputs[v].data(), filterOutputs[v].data(), filterSamples[v]);
+            }
+            
+            kernels.renderFilters(filterStates, 0, voicesCount);
+            
+            end = juce::Time::getMillisecondCounterHiRes();
+            times[2] += end - start;
+            start = end;
+            
+            output.fill(0.0f);
+            
+            // Voices have 1 to 4 unison copies, read from consecutive oscillator outputs; every other voice is stereo
+            const float leftGains[] { 0.9f, 0.7f, 0.5f, 0.3f };
+            const float rightGains[] { 0.3f, 0.5f, 0.7f, 0.9f };
+            
+            for (int v = 0; v < voicesCount; ++v) {
+                SimdKernels::OscillatorMix mix;
+                mix.osc1Outputs = oscOutputs[v].data();
+                mix.osc2Outputs = oscOutputs[v + 4].data();
+                mix.noise = noise.data();
+                mix.leftGains = leftGains;
+                mix.rightGains = v % 2 == 1 ? rightGains : nullptr;
+                mix.unison = 1 + v % 4;
+                mix.osc1Gain = 0.2f;
+                mix.osc1Level = 0.8f;
+                mix.osc2Level = 0.6f;
+                mix.osc1LevelStep = v % 2 == 0 ? -0.01f : 0.0f;
+                mix.osc2LevelStep = 0.0f;
+                mix.velocity = 0.9f;
+                mix.ringMod = v % 2 == 1;
+                mix.oscSamples = chunkSize - v % 3;
+                
+                kernels.mixOscillators(mix, mixOutputs[v].data(), mixRightOutputs[v].data(), chunkSize);
+                kernels.addMultiplied(output.data(), mixOutputs[v].data(), filterOutputs[v].data(), filterSamples[v]);
+            }
+            
+            times[3] += juce::Time::getMillisecondCounterHiRes() - start;
+        }
+        
+        /**
+         Updates the largest differences of every kernel's output with the reference, and returns the number of
+         envelopes that did not stop on the same sample.
+         */
+        int compare(const KernelsFixture& reference, std::array<float, kernelsCount>& maxDifferences) const
+        {
+            const auto update = [] (float& maxDifference, const float* a, const float* b, int numSamples) {
+                for (int i = 0; i < numSamples; ++i) {
+                    maxDifference = std::max(maxDifference, std::abs(a[i] - b[i]));
+                }
+            };
+            
+            int mismatches = 0;
+            
+            for (int o = 0; o < 2 * voicesCount; ++o) {
+                update(maxDifferences[0], oscOutputs[o].data(), reference.oscOutputs[o].data(), chunkSize);
+            }
+            
+            for (int v = 0; v < voicesCount; ++v) {
+                mismatches += activeSamples[v] != reference.activeSamples[v] ? 1 : 0;
+                update(maxDifferences[1], envOutputs[v].data(), reference.envOutputs[v].data(),
+                       std::min(activeSamples[v], reference.activeSamples[v]));
+                update(maxDifferences[2], filterOutputs[v].data(), reference.filterOutputs[v].data(), filterSamples[v]);
+                update(maxDifferences[3], mixOutputs[v].data(), reference.mixOutputs[v].data(), chunkSize);
+                update(maxDifferences[3], mixRightOutputs[v].data(), reference.mixRightOutputs[v].data(), chunkSize);
+            }
+            
+            update(maxDifferences[3], output.data(), reference.output.data(), chunkSize);
+            
+            return mismatches;
+        }
+        
+        /**
+         Returns the largest difference of the oscillator kernel's output with WavetableOscillator::renderBlock() in
+         the last chunk.
+         */
+        float compareWithRenderBlock() const
+        {
+            float maxDifference = 0.0f;
+            
+            for (int o = 0; o < 2 * voicesCount; ++o) {
+                for (int i = 0; i < chunkSize; ++i) {
+                    maxDifference = std::max(maxDifference, std::abs(oscOutputs[o][i] - blockOutputs[o][i]));
+                }
+            }
+            
+            return maxDifference;
+        }
+    };
+    
+    /**
+     Returns the THD+N of a sine rendered with phase increment increment, in dB: the power of everything in signal
+     but the sine, relative to the power of the sine. The sine's amplitude and phase are found by least squares.
+     */
+    double measureThdPlusNoise(const std::vector<float>& signal, uint32_t increment)
+    {
+        // The phase is computed like the oscillator's, so the reference has exactly the same frequency
+        const auto angle = [increment] (size_t n) {
+            return juce::MathConstants<double>::twoPi * static_cast<double>(static_cast<uint32_t>(n) * increment) / 4294967296.0;
+        };
+        
+        double sinSin = 0.0, sinCos = 0.0, cosCos = 0.0, sinSignal = 0.0, cosSignal = 0.0;
+        
+        for (size_t n = 0; n < signal.size(); ++n) {
+            const double s = std::sin(angle(n));
+            const double c = std::cos(angle(n));
+            sinSin += s * s;
+            sinCos += s * c;
+            cosCos += c * c;
+            sinSignal += s * signal[n];
+            cosSignal += c * signal[n];
+        }
+        
+        // Amplitudes of the sine and cosine that fit the signal best
+        const double determinant = sinSin * cosCos - sinCos * sinCos;
+        const double a = (sinSignal * cosCos - cosSignal * sinCos) / determinant;
+        const double b = (cosSignal * sinSin - sinSignal * sinCos) / determinant;
+        
+        double sinePower = 0.0;
+        double residualPower = 0.0;
+        
+        for (size_t n = 0; n < signal.size(); ++n) {
+            const double sine = a * std::sin(angle(n)) + b * std::cos(angle(n));
+            sinePower += sine * sine;
+            residualPower += (signal[n] - sine) * (signal[n] - sine);
+        }
+        
+        return 10.0 * std::log10(residualPower / sinePower);
+    }
+    
+    /**
+     Returns the amplitude of harmonic of a shape in the bank's tables without any limit, which is the ideal
+     band-limited shape below Nyquist.
+     */
+    double getIdealAmplitude(WavetableBank::Shape shape, int harmonic)
+    {
+        const double pi = juce::MathConstants<double>::pi;
+        
+        switch (shape) {
+            case WavetableBank::sine:
+                return harmonic == 1 ? 1.0 : 0.0;
+            case WavetableBank::triangle:
+                return harmonic % 2 == 1 ? 8.0 / (pi * pi * harmonic * harmonic) : 0.0;
+            case WavetableBank::square:
+                return harmonic % 2 == 1 ? 4.0 / (pi * harmonic) : 0.0;
+            default:
+                return 2.0 / (pi * harmonic);
+        }
+    }
+    
+    /**
+     Measures a recording of exactly periods periods of a shape, so every harmonic falls on a bin of the DFT, and
+     anything between them is aliasing (its harmonics above Nyquist, folded back) or noise. Returns in aliasing the
+     power of everything but the harmonics, and in harmonicsError the power of the difference between the amplitudes
+     of the harmonics and the ideal ones (see getIdealAmplitude()), both in dB relative to the ideal shape.
+     */
+    void measureAliasing(const std::vector<float>& signal, int periods, WavetableBank::Shape shape,
+                         double& aliasing, double& harmonicsError)
+    {
+        const size_t length = signal.size();
+        double totalPower = 0.0;
+        double mean = 0.0;
+        
+        for (const float sample : signal) {
+            totalPower += static_cast<double>(sample) * sample;
+            mean += sample;
+        }
+        
+        mean /= static_cast<double>(length);
+        totalPower = totalPower / static_cast<double>(length) - mean * mean;
+        
+        double harmonicsPower = 0.0;
+        double idealPower = 0.0;
+        double errorPower = 0.0;
+        
+        for (int harmonic = 1; static_cast<size_t>(harmonic * periods) < length / 2; ++harmonic) {
+            // LRN the Goertzel algorithm computes a single bin of the DFT with one multiply-add per sample
+            const double coefficient = 2.0 * std::cos(juce::MathConstants<double>::twoPi * harmonic * periods / static_cast<double>(length));
+            double previous = 0.0, beforePrevious = 0.0;
+            
+            for (const float sample : signal) {
+                const double current = sample + coefficient * previous - beforePrevious;
+                beforePrevious = previous;
+                previous = current;
+            }
+            
+            const double binPower = previous * previous + beforePrevious * beforePrevious - coefficient * previous * beforePrevious;
+            const double amplitude = 2.0 * std::sqrt(std::max(binPower, 0.0)) / static_cast<double>(length);
+            const double idealAmplitude = getIdealAmplitude(shape, harmonic);
+            
+            // The power of a sine is half its squared amplitude
+            harmonicsPower += 0.5 * amplitude * amplitude;
+            idealPower += 0.5 * idealAmplitude * idealAmplitude;
+            errorPower += 0.5 * (amplitude - idealAmplitude) * (amplitude - idealAmplitude);
+        }
+        
+        // Floors at -200 dB, where a signal is only rounding errors
+        const double floor = 1.0e-20 * idealPower;
+        aliasing = 10.0 * std::log10(std::max(totalPower - harmonicsPower, floor) / idealPower);
+        harmonicsError = 10.0 * std::log10(std::max(errorPower, floor) / idealPower);
+    }
+    
+    /**
+     Gives a synth the settings of a large patch: both oscillators with 3 unison copies spread in stereo, noise,
+     and both filters modulated by their envelope and the LFO, so every stage of the voices renders.
+     */
+    void setLargePatch(Synth& synth, float sampleRate)
+    {
+        // The envelopes take multipliers, like PluginProcessor::update() gives them
+        const auto multiplier = [sampleRate](float seconds) { return std::exp(-1.0f / (sampleRate * seconds)); };
+        
+        synth.osc1Level = 0.8f;
+        synth.osc2Level = 0.5f;
+        synth.noiseLevel = 0.01f;
+        synth.envAttack = multiplier(0.01f);
+        synth.envDecay = multiplier(0.5f);
+        synth.envSustain = 0.7f;
+        synth.envRelease = multiplier(0.3f);
+        synth.tune = 0.0f;
+        synth.osc2detune = std::exp2(7.0f / 12.0f);
+        synth.osc1Morph = 0.7f;
+        synth.osc2Morph = 0.3f;
+        synth.volumeTrim = 0.0005f;
+        synth.velocitySensitivity = 1.0f;
+        synth.lfoInc = 0.01f;
+        synth.vibrato = 0.005f;
+        synth.modWheel = 0.0f;
+        synth.vibratoMod = 1.0f;
+        synth.unison = 3;
+        synth.unisonDetune = 20.0f;
+        synth.unisonSpread = 0.8f;
+        synth.lpfCutoff = 3000.0f;
+        synth.lpfQ = 2.0f;
+        synth.lpfLFODepth = 0.3f;
+        synth.lpfAttack = synth.envAttack;
+        synth.lpfDecay = synth.envDecay;
+        synth.lpfSustain = 0.5f;
+        synth.lpfRelease = synth.envRelease;
+        synth.lpfEnvDepth = 1.0f;
+        synth.hpfCutoff = 100.0f;
+        synth.hpfQ = 0.707f;
+        synth.hpfLFODepth = 0.0f;
+        synth.hpfAttack = synth.envAttack;
+        synth.hpfDecay = synth.envDecay;
+        synth.hpfSustain = 0.5f;
+        synth.hpfRelease = synth.envRelease;
+        synth.hpfEnvDepth = 1.0f;
+        synth.polyMode = 1;
+        synth.maxPolyphony = constants::MAX_VOICES;
+        synth.noiseType = 0;
+        synth.ignoreVelocity = false;
+        synth.ringMod = false;
+        synth.phaseRand = false;
+    }
+}
+
+void Benchmarks::runOnce(float sampleRate)
+{
+    // Not a std::call_once, which would never return to the synths prepared by the benchmarks themselves
+    static std::atomic<bool> started { false };
+
+    if (started.exchange(true)) {
+        return;
+    }
+    
+    const SimdKernels& kernels = SimdKernels::select();
+    
+    juce::Logger::writeToLog("cppsynth benchmarks at " + juce::String(sampleRate) + " Hz, rendering with the "
+                             + kernels.name + " kernels (" + juce::String(kernels.width) + " lanes)");
+    reportWavetableFormats(sampleRate);
+    reportSimdKernels(sampleRate);
+    reportInterpolation(sampleRate);
+    reportOscillatorEngines(sampleRate);
+    reportRenderThreads(sampleRate);
+    reportInstantiation(sampleRate);
+}
+
+void Benchmarks::reportWavetableFormats(float sampleRate)
+{
+    // The float tables of a whole bank are the reference
+    std::vector<std::vector<float>> tables;
+
+    for (int level = 0; level < constants::WAVETABLE_LEVELS_COUNT; ++level) {
+        const int harmonicsLimit = WavetableBank::getHarmonicsLimit(level, sampleRate);
+
+        tables.push_back(WavetableGenerator::generateSineWavetable());
+        tables.push_back(WavetableGenerator::generateTriangleWavetable(harmonicsLimit));
+        tables.push_back(WavetableGenerator::generateSquareWavetable(harmonicsLimit));
+        tables.push_back(WavetableGenerator::generateSawtoothWavetable(harmonicsLimit));
+    }
+
+    reportFormat<wavetableFormats::Float32>(tables);
+    reportFormat<wavetableFormats::Int16>(tables);
+    reportFormat<wavetableFormats::Float16>(tables);
+}
+
+void Benchmarks::reportSimdKernels(float sampleRate)
+{
+    constexpr int chunksCount { 20000 };
+    constexpr int chunkSize { constants::LOWER_UPDATE_RATE_MAX_VALUE };
+    const char* kernelNames[] { "oscillators", "envelopes", "filters", "mixing" };
+    
+    auto bank = WavetableBank::getSharedBank(sampleRate);
+    const SimdKernels* reference = SimdKernels::get(SimdKernels::scalar);
+    
+    for (int level = SimdKernels::scalar; level < SimdKernels::numLevels; ++level) {
+        const SimdKernels* kernels = SimdKernels::get(static_cast<SimdKernels::Level>(level));
+        
+        if (kernels == nullptr) {
+            continue;
+        }
+        
+        // The same voices, rendered by the scalar kernels (the reference) and by the measured kernels
+        KernelsFixture referenceFixture(*bank, sampleRate);
+        KernelsFixture fixture(*bank, sampleRate);
+        std::array<double, KernelsFixture::kernelsCount> referenceTimes {};
+        std::array<double, KernelsFixture::kernelsCount> times {};
+        std::array<float, KernelsFixture::kernelsCount> maxDifferences {};
+        float renderBlockDifference = 0.0f;
+        int activeSamplesMismatches = 0;
+        
+        for (int chunk = 0; chunk < chunksCount; ++chunk) {
+            referenceFixture.renderChunk(*reference, chunk, referenceTimes);
+            fixture.renderChunk(*kernels, chunk, times);
+            activeSamplesMismatches += fixture.compare(referenceFixture, maxDifferences);
+            renderBlockDifference = std::max(renderBlockDifference, fixture.compareWithRenderBlock());
+        }
+        
+        juce::String report = juce::String(kernels->name) + " kernels (" + juce::String(kernels->width) + " lanes), ns/sample:";
+        
+        for (int k = 0; k < KernelsFixture::kernelsCount; ++k) {
+            const double samplesCount = static_cast<double>(KernelsFixture::lanesCounts[k]) * chunkSize * chunksCount;
+            
+            report += juce::String(" ") + kernelNames[k] + " " + juce::String(times[k] * 1.0e6 / samplesCount, 2)
+                    + " (max difference " + juce::String(maxDifferences[k]) + ")";
+            
+            jassert(maxDifferences[k] <= SimdKernels::tolerance);
+        }
+        
+        // The oscillators are also checked against the scalar oscillator the kernels replaced
+        report += " (max difference with WavetableOscillator::renderBlock " + juce::String(renderBlockDifference) + ")";
+        jassert(renderBlockDifference <= SimdKernels::renderBlockTolerance);
+        
+        juce::Logger::writeToLog(report);
+        
+        if (activeSamplesMismatches > 0) {
+            juce::Logger::writeToLog("  envelopes stopped on a different sample " + juce::String(activeSamplesMismatches) + " times");
+        }
+    }
+}
+
+void Benchmarks::reportInterpolation(float sampleRate)
+{
+    constexpr int lanesCount { 2 * constants::DEFAULT_POLYPHONY };
+    constexpr int chunkSize { constants::LOWER_UPDATE_RATE_MAX_VALUE };
+    constexpr int chunksCount { 4096 };
+    const char* modeNames[] { "truncation", "linear", "cubic Hermite", "Lagrange" };
+    
+    // A low note and a high one; the error of the interpolation grows with the frequency
+    constexpr int frequenciesCount { 2 };
+    const float frequencies[frequenciesCount] { 440.0f, 3520.0f };
+    
+    auto bank = WavetableBank::getSharedBank(sampleRate);
+    const SimdKernels& kernels = SimdKernels::select();
+    
+    for (int mode = 0; mode < interpolation::numModes; ++mode) {
+        // Every oscillator plays a sine; the first ones of each frequency are recorded
+        std::vector<WavetableOscillator> oscillators;
+        std::vector<std::vector<float>> recordings(frequenciesCount, std::vector<float>(chunksCount * chunkSize));
+        std::array<std::array<float, chunkSize>, lanesCount> outputs;
+        std::array<WavetableOscillator::Lane, lanesCount> lanes;
+        double time = 0.0;
+        
+        for (int l = 0; l < lanesCount; ++l) {
+            const float frequency = frequencies[l % frequenciesCount];
+            oscillators.emplace_back(&bank->getMorphFrames(WavetableBank::getLevelForFrequency(frequency)), sampleRate);
+            oscillators.back().setFrequency(frequency);
+            oscillators.back().setMorph(0.0f);
+        }
+        
+        for (int chunk = 0; chunk < chunksCount; ++chunk) {
+            for (int l = 0; l < lanesCount; ++l) {
+                oscillators[l].prepareLane(lanes[l], outputs[l].data());
+            }
+            
+            const double start = juce::Time::getMillisecondCounterHiRes();
+            kernels.renderOscillators(lanes.data(), lanesCount, chunkSize, static_cast<interpolation::Mode>(mode));
+            time += juce::Time::getMillisecondCounterHiRes() - start;
+            
+            for (int l = 0; l < lanesCount; ++l) {
+                oscillators[l].finishLane(lanes[l]);
+            }
+            
+            for (int f = 0; f < frequenciesCount; ++f) {
+                std::copy(outputs[f].begin(), outputs[f].end(), recordings[f].begin() + chunk * chunkSize);
+            }
+        }
+        
+        juce::String report = juce::String("Interpolation ") + modeNames[mode] + ": "
+                            + juce::String(time * 1.0e6 / (static_cast<double>(lanesCount) * chunkSize * chunksCount), 2)
+                            + " ns/sample (" + kernels.name + "), THD+N";
+        
+        for (int f = 0; f < frequenciesCount; ++f) {
+            // Same fixed-point increment as WavetableOscillator::setFrequency()
+            const auto increment = static_cast<uint32_t>(static_cast<int64_t>(static_cast<double>(frequencies[f]) / sampleRate * 4294967296.0));
+            report += " " + juce::String(measureThdPlusNoise(recordings[f], increment), 1) + " dB at "
+                    + juce::String(frequencies[f]) + " Hz";
+        }
+        
+        juce::Logger::writeToLog(report);
+    }
+}
+
+void Benchmarks::reportOscillatorEngines(float sampleRate)
+{
+    constexpr int lanesCount { 2 * constants::DEFAULT_POLYPHONY };
+    constexpr int chunkSize { constants::LOWER_UPDATE_RATE_MAX_VALUE };
+    
+    // 2^16 samples hold a whole number of periods of every note: their phase increment is a multiple of 2^16 (an
+    //  odd one, so the harmonics folded back never land on other harmonics)
+    constexpr int recordingLength { 1 << 16 };
+    constexpr int chunksCount { recordingLength / chunkSize };
+    static_assert(recordingLength % chunkSize == 0, "the recording must be made of whole chunks");
+    
+    const char* shapeNames[] { "sine", "triangle", "square", "saw" };
+    const char* engineNames[] { "wavetable", "PolyBLEP", "additive" };
+    constexpr int notesCount { 3 };
+    const float noteFrequencies[notesCount] { 440.0f, 1760.0f, 7040.0f };
+    
+    auto bank = WavetableBank::getSharedBank(sampleRate);
+    const SimdKernels& kernels = SimdKernels::select();
+    auto partials = std::make_unique<AdditiveOscillator::Partials>();
+    
+    for (int shape = WavetableBank::triangle; shape < WavetableBank::numShapes; ++shape) {
+        const float morph = static_cast<float>(shape) * constants::MORPH_FRAME_WIDTH;
+        
+        for (int engine = 0; engine < oscillatorEngine::numEngines; ++engine) {
+            juce::String report = juce::String(engineNames[engine]) + " " + shapeNames[shape] + ":";
+            double time = 0.0;
+            
+            for (int note = 0; note < notesCount; ++note) {
+                const int periods = (static_cast<int>(noteFrequencies[note] / sampleRate * recordingLength) / 2) * 2 + 1;
+                const float frequency = static_cast<float>(periods) * sampleRate / static_cast<float>(recordingLength);
+                
+                // Every oscillator plays the note, as many voices would; the first one is recorded
+                std::vector<WavetableOscillator> oscillators;
+                std::vector<PolyBlepOscillator> polyBlepOscillators;
+                std::vector<AdditiveOscillator> additiveOscillators;
+                std::array<std::array<float, chunkSize>, lanesCount> outputs;
+                std::array<WavetableOscillator::Lane, lanesCount> lanes;
+                std::vector<float> recording(recordingLength);
+                
+                for (int l = 0; l < lanesCount; ++l) {
+                    oscillators.emplace_back(&bank->getMorphFrames(WavetableBank::getLevelForFrequency(frequency)), sampleRate);
+                    oscillators.back().setFrequency(frequency);
+                    oscillators.back().setMorph(morph);
+                    polyBlepOscillators.emplace_back(sampleRate);
+                    polyBlepOscillators.back().setFrequency(frequency);
+                    polyBlepOscillators.back().setMorph(morph);
+                    additiveOscillators.emplace_back(sampleRate);
+                    additiveOscillators.back().setFrequency(frequency);
+                    additiveOscillators.back().setMorph(morph);
+                }
+                
+                for (int chunk = 0; chunk < chunksCount; ++chunk) {
+                    if (engine == oscillatorEngine::wavetable) {
+                        for (int l = 0; l < lanesCount; ++l) {
+                            oscillators[l].prepareLane(lanes[l], outputs[l].data());
+                        }
+                        
+                        const double start = juce::Time::getMillisecondCounterHiRes();
+                        kernels.renderOscillators(lanes.data(), lanesCount, chunkSize, interpolation::linear);
+                        time += juce::Time::getMillisecondCounterHiRes() - start;
+                        
+                        for (int l = 0; l < lanesCount; ++l) {
+                            oscillators[l].finishLane(lanes[l]);
+                        }
+                    }
+                    else if (engine == oscillatorEngine::polyBlep) {
+                        const double start = juce::Time::getMillisecondCounterHiRes();
+                        
+                        for (int l = 0; l < lanesCount; ++l) {
+                            polyBlepOscillators[l].renderBlock(outputs[l].data(), chunkSize, nullptr);
+                        }
+                        
+                        time += juce::Time::getMillisecondCounterHiRes() - start;
+                    }
+                    else {
+                        const double start = juce::Time::getMillisecondCounterHiRes();
+                        
+                        for (int l = 0; l < lanesCount; ++l) {
+                            additiveOscillators[l].renderBlock(kernels, *partials, outputs[l].data(), chunkSize);
+                        }
+                        
+                        time += juce::Time::getMillisecondCounterHiRes() - start;
+                    }
+                    
+                    std::copy(outputs[0].begin(), outputs[0].end(), recording.begin() + chunk * chunkSize);
+                }
+                
+                double aliasing = 0.0;
+                double harmonicsError = 0.0;
+                measureAliasing(recording, periods, static_cast<WavetableBank::Shape>(shape), aliasing, harmonicsError);
+                
+                report += " " + juce::String(frequency, 1) + " Hz aliasing " + juce::String(aliasing, 1)
+                        + " dB, harmonics error " + juce::String(harmonicsError, 1) + " dB;";
+            }
+            
+            const double samplesCount = static_cast<double>(lanesCount) * recordingLength * notesCount;
+            report += " " + juce::String(time * 1.0e6 / samplesCount, 2) + " ns/sample";
+            
+            if (engine != oscillatorEngine::polyBlep) {
+                report += juce::String(" (") + kernels.name + ")";
+            }
+            
+            juce::Logger::writeToLog(report);
+        }
+    }
+}
+
+void Benchmarks::reportRenderThreads(float sampleRate)
+{
+    constexpr int blockSize { 64 };
+    constexpr int warmUpBlocksCount { 200 };
+    constexpr int blocksCount { 2000 };
+    // A chord on the default polyphony, every voice thick with unison, as a pad would play
+    constexpr int voicesCount { constants::DEFAULT_POLYPHONY };
+    constexpr int unisonCount { 8 };
+    
+    // The synth keeps one worker for every core but the audio thread's; more threads would only wait for cores
+    const int threadsLimit = std::min(juce::SystemStats::getNumPhysicalCpus(), constants::MAX_RENDER_THREADS);
+    
+    auto synth = std::make_unique<Synth>();
+    setLargePatch(*synth, sampleRate);
+    synth->maxPolyphony = voicesCount;
+    synth->unison = unisonCount;
+    synth->allocateResources(sampleRate, blockSize);
+    
+    std::array<float, blockSize> left;
+    std::array<float, blockSize> right;
+    float* outputs[] { left.data(), right.data() };
+    const double blockTime = 1000.0 * blockSize / sampleRate;
+    double singleThreadTime = 0.0;
+    juce::String report = "render threads with " + juce::String(voicesCount) + " voices of " + juce::String(unisonCount)
+                        + " unison copies, "
+                        + juce::String(blockSize) + "-sample blocks (" + juce::String(blockTime, 3) + " ms), ms/block:";
+    
+    for (int threads = 1; threads <= constants::MAX_RENDER_THREADS; ++threads) {
+        if (threads > threadsLimit) {
+            report += " " + juce::String(threads) + "+ skipped (" + juce::String(threadsLimit) + " cores)";
+            break;
+        }
+        
+        // Every voice plays a note again, from the same state
+        synth->renderThreads = threads;
+        synth->prepareRenderThreads(threads);
+        synth->reset();
+        synth->outputLevelSmoother.setCurrentAndTargetValue(1.0f);
+        
+        for (int note = 0; note < voicesCount; ++note) {
+            synth->midiMessage(0x90, static_cast<uint8_t>(48 + note * 3), 100);
+        }
+        
+        for (int block = 0; block < warmUpBlocksCount; ++block) {
+            synth->render(outputs, blockSize);
+        }
+        
+        const double start = juce::Time::getMillisecondCounterHiRes();
+        
+        for (int block = 0; block < blocksCount; ++block) {
+            synth->render(outputs, blockSize);
+        }
+        
+        const double time = (juce::Time::getMillisecondCounterHiRes() - start) / blocksCount;
+        
+        if (threads == 1) {
+            singleThreadTime = time;
+        }
+        
+        report += " " + juce::String(threads) + ": " + juce::String(time, 3) + " (x" + juce::String(singleThreadTime / time, 2) + ")";
+    }
+    
+    juce::Logger::writeToLog(report);
+}
+
+void Benchmarks::reportInstantiation(float sampleRate)
+{
+    constexpr int instancesCount { 16 };
+    constexpr int samplesPerBlock { 512 };
+    
+    // A sample rate no other synth uses, so no bank is shared yet, and an empty cache: the first instance generates
+    //  the wavetables, as on a machine where the synth never ran
+    const float instancesSampleRate = sampleRate * 2.0f;
+    const juce::File cacheDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+        .getNonexistentChildFile("cppsynth_benchmark_cache", "", false);
+    WavetableCache::setDirectory(cacheDirectory);
+    
+    std::vector<std::unique_ptr<Synth>> synths;
+    std::vector<double> times;
+    
+    for (int i = 0; i < instancesCount; ++i) {
+        const double start = juce::Time::getMillisecondCounterHiRes();
+        synths.push_back(std::make_unique<Synth>());
+        synths.back()->allocateResources(instancesSampleRate, samplesPerBlock);
+        times.push_back(juce::Time::getMillisecondCounterHiRes() - start);
+    }
+    
+    double othersTime = 0.0;
+    
+    for (int i = 1; i < instancesCount; ++i) {
+        othersTime += times[i];
+    }
+    
+    // The bank goes with the last synth, so the next instance loads the cache file written by the first one, as
+    //  the first instance of every later session does
+    synths.clear();
+    
+    const double start = juce::Time::getMillisecondCounterHiRes();
+    auto cachedSynth = std::make_unique<Synth>();
+    cachedSynth->allocateResources(instancesSampleRate, samplesPerBlock);
+    const double cachedTime = juce::Time::getMillisecondCounterHiRes() - start;
+    
+    cachedSynth.reset();
+    WavetableCache::setDirectory(juce::File());
+    cacheDirectory.deleteRecursively();
+    
+    juce::Logger::writeToLog("instantiation at " + juce::String(instancesSampleRate, 0) + " Hz, ms/instance: first "
+                             + juce::String(times[0], 2) + " (generating the wavetables), next ones "
+                             + juce::String(othersTime / (instancesCount - 1), 2) + " on average (sharing them), "
+                             + "first of a later session " + juce::String(cachedTime, 2) + " (loading the cache file)");
+}
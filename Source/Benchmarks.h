@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Created: 11 Oct 2026 2:15:37pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ Set to 1 in the exporter's preprocessor definitions to run the benchmarks when the synth is first prepared.
+ */
+#ifndef CPPSYNTH_BENCHMARKS
+ #define CPPSYNTH_BENCHMARKS 0
+#endif
+
+/**
+ This class contains measurements used to choose the synth's build options for a deployment (sample formats,
+ algorithms...). The results are written to the JUCE logger, so they also show in release builds.
+ */
+class Benchmarks
+{
+public:
+    /**
+     Runs every benchmark, only the first time it is called in the process.
+     */
+    static void runOnce(float sampleRate);
+
+    /**
+     Measures the signal-to-noise ratio of every wavetable sample format against the float tables, with the memory
+     used by the tables of a bank in each format.
+     */
+    static void reportWavetableFormats(float sampleRate);
+    
+    /**
+     Renders the oscillators, envelopes, filters and mixes of every voice with each set of SIMD kernels the
+     processor supports, and compares their speed and their output with the scalar kernels; the oscillators are also
+     compared with WavetableOscillator::renderBlock(), the scalar code the kernels replaced.
+     */
+    static void reportSimdKernels(float sampleRate);
+    
+    /**
+     Renders sines with every interpolation mode, using the kernels the synth selects, and reports the time each
+     mode takes per oscillator sample with the THD+N of the sines it plays.
+     */
+    static void reportInterpolation(float sampleRate);
+    
+    /**
+     Renders the triangle, square and saw of every oscillator engine (the wavetables through the kernels the synth
+     selects, with the realtime interpolation, PolyBLEP, and the additive partials through the same kernels) at a
+     low, a high and a very high note, and reports the time each takes per oscillator sample with the power of its
+     aliasing and the error of its harmonics.
+     */
+    static void reportOscillatorEngines(float sampleRate);
+    
+    /**
+     Renders a synth playing a chord of constants::DEFAULT_POLYPHONY voices with a thick unison, in blocks of 64
+     samples, with 1 to constants::MAX_RENDER_THREADS threads (as many as the processor has cores), and reports the
+     time each takes per block with its speedup over the audio thread alone.
+     */
+    static void reportRenderThreads(float sampleRate);
+    
+    /**
+     Prepares several synths one after the other, as a session with many instances would, and reports the time
+     each takes: the first one generates the wavetables (the cache is moved to an empty directory meanwhile), the
+     others share them, and one prepared after they are gone loads them from the cache file.
+     */
+    static void reportInstantiation(float sampleRate);
+};
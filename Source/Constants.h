@@ -34,8 +34,48 @@ namespace constants
     inline constexpr float ENV_SUS_TARGET { 1.0f };
     inline constexpr float ENV_REL_TARGET { 0.0f };
 
-    // Maximum of voices for this synth
-    inline constexpr int MAX_VOICES { 10 };
+    // Maximum of voices for this synth; they are all allocated beforehand, and the polyphony parameter chooses how
+    //  many of them may play
+    inline constexpr int MAX_VOICES { 128 };
+
+    // Default of the polyphony parameter
+    inline constexpr int DEFAULT_POLYPHONY { 10 };
+
+    // Number of MIDI notes, which is the most notes that can be held at once
+    inline constexpr int MIDI_NOTES_COUNT { 128 };
+
+    // Slots of the voices' hot state (envelopes and filters), stored as arrays of one value per voice: the voices
+    //  rounded up to a multiple of the widest SIMD vector (16 floats), so the kernels load whole vectors of slots
+    inline constexpr int VOICE_SLOTS { (MAX_VOICES + 15) / 16 * 16 };
+
+    // Most threads rendering the voices of a synth in multi-core mode: the audio thread and the pool's workers
+    inline constexpr int MAX_RENDER_THREADS { 16 };
+
+    // Group of voice slots that always goes to a single task in multi-core mode: a 64-byte cache line of every state
+    //  array, and the widest SIMD vector, so two threads never write the same line nor vector of slots
+    inline constexpr int RENDER_TASK_SLOTS { 16 };
+    static_assert(MAX_VOICES % RENDER_TASK_SLOTS == 0, "Every group of voice slots has its voices");
+
+    // Maximum of detuned copies of each oscillator in a voice (unison)
+    inline constexpr int MAX_UNISON { 16 };
+
+    // Highest oversampling factor of the phase modulation of OSC1 by OSC2
+    inline constexpr int MAX_FM_OVERSAMPLING { 4 };
+
+    // Phase deviation of OSC1 for a full FM amount and a full-scale OSC2, in periods
+    inline constexpr float FM_MAX_DEPTH { 1.0f };
+
+    // Most partials of an additive oscillator (a multiple of the widest SIMD vector, 16 floats)
+    inline constexpr int MAX_PARTIALS { 256 };
+
+    // Range of the filters' modulated cutoff, in Hz; at the ends of it (without resonance), the low-pass filter is
+    //  fully open and the high-pass filter lets everything audible through, so they are left out of the chain
+    inline constexpr float FILTER_MIN_CUTOFF { 30.0f };
+    inline constexpr float FILTER_MAX_CUTOFF { 20000.0f };
+
+    // Length of the ramps of the levels, and of the crossfades of the filters going in and out of the chain, in
+    //  samples; long enough not to click, short enough to follow the knobs
+    inline constexpr int RAMP_SAMPLES { 256 };
 
     // Analog oscillator drift factor
     inline constexpr float ANALOG_DRIFT { 0.002f };
@@ -44,11 +84,31 @@ namespace constants
     // Will be multiplied by the inverse of the sample rate
     inline constexpr int LOWER_UPDATE_RATE_MAX_VALUE { 32 };
 
-    // Max oscillators count is number of MIDI notes available
-    inline constexpr int WAVETABLE_OSCILLATORS_COUNT { 128 };
+    // Longest segment every voice renders in its own buffers before the voices are mixed down; longer blocks are
+    //  rendered in several segments
+    inline constexpr int MAX_SEGMENT_SAMPLES { 256 };
+
+    // Wavetable sample size; a power of two, so the oscillators' phase wraps around for free
+    inline constexpr int WAVETABLE_LENGTH_BITS { 11 };
+    inline constexpr int WAVETABLE_LENGTH { 1 << WAVETABLE_LENGTH_BITS };
+
+    // Copies of the first samples stored after each table, so interpolation never wraps its index
+    inline constexpr int WAVETABLE_GUARD_SAMPLES { 1 };
+
+    // Samples stored per table (table and guard samples)
+    inline constexpr int WAVETABLE_STRIDE { WAVETABLE_LENGTH + WAVETABLE_GUARD_SAMPLES };
+
+    // Number of harmonics levels for the band-limited wavetables; each level covers one octave
+    inline constexpr int WAVETABLE_LEVELS_COUNT { 10 };
+
+    // Highest frequency played with the first (richest) wavetable level, in Hz
+    inline constexpr float WAVETABLE_FIRST_LEVEL_MAX_FREQUENCY { 40.0f };
+
+    // Highest harmonic of the triangle wave; I feel that 10 harmonics is enough (odd harmonics only, so up to the 19th)
+    inline constexpr int TRIANGLE_MAX_HARMONIC { 19 };
 
-    // Wavetable sample size
-    inline constexpr int WAVETABLE_LENGTH { 2048 };
+    // Morph range between two consecutive wave shapes (sine, triangle, square, saw)
+    inline constexpr float MORPH_FRAME_WIDTH { 0.33f };
 
     // Samples to add to envelop attack/release to prevent pop
     inline constexpr int POP_PREVENT_SAMPLES { 2500 };
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    EngineStateBuilder.cpp
+    Created: 9 Oct 2026 2:47:53pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "EngineStateBuilder.h"
+
+EngineStateBuilder::EngineStateBuilder() : juce::Thread("cppsynth engine state builder") {}
+
+EngineStateBuilder::~EngineStateBuilder()
+{
+    stopThread(2000);
+
+    // Nothing else can touch the states anymore
+    delete pendingState.exchange(nullptr);
+    deleteRetiredStates();
+}
+
+void EngineStateBuilder::publishNow(float sampleRate, std::shared_ptr<const WavetableBank> wavetableBank)
+{
+    const juce::ScopedLock sl(publishLock);
+
+    latestSampleRate = sampleRate;
+    latestBank = wavetableBank;
+    publish(std::make_unique<EngineState>(EngineState { sampleRate, std::move(wavetableBank) }));
+}
+
+void EngineStateBuilder::requestSampleRate(float sampleRate)
+{
+    const juce::ScopedLock sl(publishLock);
+
+    // publishNow() must have been called at least once, so there is always a bank to render with
+    jassert(latestBank != nullptr);
+
+    latestSampleRate = sampleRate;
+
+    if (auto bank = WavetableBank::findSharedBank(sampleRate)) {
+        latestBank = std::move(bank);
+    }
+    else {
+        // Keep rendering with the latest bank (only the harmonics limits are off) until the new one is ready
+        pendingSampleRate.store(sampleRate);
+        notify();
+    }
+
+    publish(std::make_unique<EngineState>(EngineState { sampleRate, latestBank }));
+}
+
+EngineState* EngineStateBuilder::takeNewState()
+{
+    return pendingState.exchange(nullptr);
+}
+
+void EngineStateBuilder::retire(EngineState* state)
+{
+    if (state == nullptr) { return; }
+
+    int start1, size1, start2, size2;
+    retiredFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0) {
+        // The background thread is late; leak the state rather than freeing memory on the audio thread
+        jassertfalse;
+        return;
+    }
+
+    retiredStates[static_cast<size_t>(size1 > 0 ? start1 : start2)] = state;
+    retiredFifo.finishedWrite(1);
+}
+
+void EngineStateBuilder::run()
+{
+    while (!threadShouldExit()) {
+        deleteRetiredStates();
+
+        const float sampleRate = pendingSampleRate.exchange(0.0f);
+
+        if (sampleRate > 0.0f) {
+            // This is the slow part, which may generate all the tables
+            auto bank = WavetableBank::getSharedBank(sampleRate);
+
+            const juce::ScopedLock sl(publishLock);
+
+            // Drop the bank if another sample rate was requested in the meantime
+            if (juce::roundToInt(sampleRate) == juce::roundToInt(latestSampleRate)) {
+                latestBank = bank;
+                publish(std::make_unique<EngineState>(EngineState { sampleRate, std::move(bank) }));
+            }
+
+            continue;
+        }
+
+        // Woken up by new requests; retired states are deleted at least twice per second
+        wait(500);
+    }
+}
+
+void EngineStateBuilder::publish(std::unique_ptr<EngineState> state)
+{
+    // The background thread is only needed once there is something to publish or delete
+    if (!isThreadRunning()) {
+        startThread();
+    }
+
+    // A state the audio thread did not take yet was never used, so it can be deleted here
+    delete pendingState.exchange(state.release());
+}
+
+void EngineStateBuilder::deleteRetiredStates()
+{
+    int start1, size1, start2, size2;
+    retiredFifo.prepareToRead(retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i) {
+        delete retiredStates[static_cast<size_t>(start1 + i)];
+    }
+    for (int i = 0; i < size2; ++i) {
+        delete retiredStates[static_cast<size_t>(start2 + i)];
+    }
+
+    retiredFifo.finishedRead(size1 + size2);
+}
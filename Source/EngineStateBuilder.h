@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    EngineStateBuilder.h
+    Created: 9 Oct 2026 2:47:53pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "WavetableBank.h"
+
+/**
+ Everything the audio thread needs to render at a given sample rate. A state is never modified once it has been
+ published; a new state is built instead.
+ */
+struct EngineState
+{
+    float sampleRate;
+    std::shared_ptr<const WavetableBank> wavetableBank;
+};
+
+/**
+ This class prepares new engine states away from the audio thread, and hands them over to it without locks.
+ Building a wavetable bank can take a while, so it is done on a background thread, while the audio thread keeps
+ rendering with the state it has. A finished state is published in an atomic pointer, which the audio thread
+ swaps out at the start of its next block (read-copy-update). The state it replaces is given back through a
+ lock-free FIFO and deleted later on the background thread, so the audio thread never frees memory.
+ */
+class EngineStateBuilder : private juce::Thread
+{
+public:
+    EngineStateBuilder();
+    ~EngineStateBuilder() override;
+
+    /**
+     Message thread. Builds a state for the sample rate with the given bank, and publishes it right away.
+     */
+    void publishNow(float sampleRate, std::shared_ptr<const WavetableBank> wavetableBank);
+
+    /**
+     Message thread. Publishes a state for a new sample rate without blocking. If another synth already holds
+     the bank for this sample rate, it is used right away; otherwise the state keeps the latest bank until the
+     right one is built on the background thread and published in a second state.
+     */
+    void requestSampleRate(float sampleRate);
+
+    /**
+     Audio thread. Returns the latest published state that was not taken yet, or nullptr. Never blocks.
+     The caller owns the state until it gives it back with retire().
+     */
+    EngineState* takeNewState();
+
+    /**
+     Audio thread. Gives back a state that is no longer used, so it can be deleted on the background thread.
+     Never blocks.
+     */
+    void retire(EngineState* state);
+
+private:
+    static constexpr int retiredCapacity { 16 };
+
+    std::atomic<EngineState*> pendingState { nullptr }; // published, not yet taken by the audio thread
+    std::atomic<float> pendingSampleRate { 0.0f }; // sample rate whose bank must be built, 0 if none
+
+    // LRN AbstractFifo only manages the read/write positions of a ring buffer; with one writer (audio thread)
+    //  and one reader (background thread) it needs no lock
+    juce::AbstractFifo retiredFifo { retiredCapacity };
+    std::array<EngineState*, retiredCapacity> retiredStates {};
+
+    juce::CriticalSection publishLock; // between the message thread and the background thread
+    std::shared_ptr<const WavetableBank> latestBank; // bank of the last published state
+    float latestSampleRate = 0.0f; // sample rate of the last request
+
+    /**
+     Background thread loop; builds the requested banks and deletes retired states.
+     */
+    void run() override;
+
+    /**
+     Makes a state available to the audio thread, replacing any published state it did not take yet.
+     */
+    void publish(std::unique_ptr<EngineState> state);
+
+    /**
+     Deletes the states retired by the audio thread.
+     */
+    void deleteRetiredStates();
+
+    JUCE_DECLARE_NON_COPYABLE(EngineStateBuilder)
+};
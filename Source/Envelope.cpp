@@ -10,14 +10,20 @@
 
 #include "Envelope.h"
 
+void Envelope::bind(States& newStates, int newSlot)
+{
+    states = &newStates;
+    slot = newSlot;
+}
+
 bool Envelope::isActive() const
 {
-    return level > constants::SILENCE_TRESHOLD;
+    return states->level[slot] > constants::SILENCE_TRESHOLD;
 }
 
 bool Envelope::isInAttack() const
 {
-    return target >= constants::ENV_ATK_TARGET;
+    return states->target[slot] >= constants::ENV_ATK_TARGET;
 }
 
 void Envelope::attack()
@@ -28,13 +34,19 @@ void Envelope::attack()
      Give extra boost (silence tresh) so that the initial envelope is always greater than silence. 
      The += assignement enables legato-style playing continue envelope instead of restarting it)
      */
-    level += constants::SILENCE_TRESHOLD + constants::SILENCE_TRESHOLD;
-    target = constants::ENV_ATK_TARGET;
-    multiplier = attackMultiplier;
+    states->level[slot] += constants::SILENCE_TRESHOLD + constants::SILENCE_TRESHOLD;
+    states->target[slot] = constants::ENV_ATK_TARGET;
+    states->multiplier[slot] = attackMultiplier;
+    states->decayMultiplier[slot] = decayMultiplier;
+    states->sustainLevel[slot] = sustainLevel;
 }
 
 float Envelope::nextValue()
 {
+    float& level = states->level[slot];
+    float& multiplier = states->multiplier[slot];
+    float& target = states->target[slot];
+    
     // Exponentially reach target by applying a one-pole filter with the formula :
     //  y[n] = (1 - a) * x[n] + a * y[n - 1], where y[n] is the level at the current sample step n,
     //  x[n] is the target level, a is the multiplier and y[n-1] is the level at the previous sample step n
@@ -44,8 +56,8 @@ float Envelope::nextValue()
     // To know if we're in the attack stage, we'll consider a target of 2.0 instead of the
     //  sustain's 1.0; once we've reach the end of the attack stage, switch to decay stage
     if (level + target > constants::ENV_SUS_TARGET + constants::ENV_ATK_TARGET) {
-        multiplier = decayMultiplier;
-        target = sustainLevel;
+        multiplier = states->decayMultiplier[slot];
+        target = states->sustainLevel[slot];
     }
     
     return level;
@@ -53,14 +65,14 @@ float Envelope::nextValue()
 
 void Envelope::reset()
 {
-    level = 0.0f;
-    target = constants::ENV_REL_TARGET;
-    multiplier = 0.0f;
+    states->level[slot] = 0.0f;
+    states->target[slot] = constants::ENV_REL_TARGET;
+    states->multiplier[slot] = 0.0f;
 }
 
 void Envelope::release()
 {
     // Release stage : Set the target to 0 and set the multiplier to the release multiplier
-    target = constants::ENV_REL_TARGET;
-    multiplier = releaseMultiplier;
+    states->target[slot] = constants::ENV_REL_TARGET;
+    states->multiplier[slot] = releaseMultiplier;
 }
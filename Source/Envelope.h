@@ -10,22 +10,54 @@
 
 #pragma once
 
+#include <array>
 #include "Constants.h"
 
 /**
  This class represents an ADSR envelope. The inner working is that of a one-pole filter.
+ The state that changes with every sample lives in States, next to the state of the other voices' envelopes; an
+ envelope is a view of its slot there, and only keeps its settings.
  */
 class Envelope
 {
 public:
-    float level; // output level of the envelope
-
     // different multiplier values are used at different stages of the envelope
     float attackMultiplier;
     float decayMultiplier;
     float sustainLevel; // sustain is not a stage in itself
     float releaseMultiplier;
     
+    /**
+     State of the envelopes of every voice, one slot per voice, rendered by the SIMD kernels a vector of slots at a
+     time. Slots without an envelope stay inactive.
+     */
+    struct States
+    {
+        alignas(64) std::array<float, constants::VOICE_SLOTS> level {}; // output level of the envelope
+        alignas(64) std::array<float, constants::VOICE_SLOTS> multiplier {}; // multiplier of the current stage
+        alignas(64) std::array<float, constants::VOICE_SLOTS> target {}; // target value of the envelope
+        // settings of the decay stage, copied at each attack since the kernels switch to it
+        alignas(64) std::array<float, constants::VOICE_SLOTS> decayMultiplier {};
+        alignas(64) std::array<float, constants::VOICE_SLOTS> sustainLevel {};
+        // set by the kernel: samples rendered until the envelope became inactive (included)
+        alignas(64) std::array<int, constants::VOICE_SLOTS> activeSamples {};
+    };
+    
+    /**
+     Makes this envelope the view of a slot of states, which must stay alive as long as it is used.
+     */
+    void bind(States& newStates, int newSlot);
+    
+    /**
+     Returns the output level of the envelope.
+     */
+    float getLevel() const { return states->level[slot]; }
+    
+    /**
+     Returns the samples rendered by the last call of the kernels until the envelope became inactive (included).
+     */
+    int getActiveSamples() const { return states->activeSamples[slot]; }
+    
     /**
      Returns active status of the envelope.
      */
@@ -55,7 +87,8 @@ public:
      Sets the target to 0 and sets the multiplier to the release multiplier.
      */
     void release();
+    
 private:
-    float multiplier; // envelope multiplier to calculate slope from 1.0 to silence
-    float target; // Target value of the envelope
+    States* states = nullptr;
+    int slot = 0;
 };
@@ -22,24 +22,19 @@ public:
     {
         g = std::tan(constants::PI * cutoff / sampleRate);
         k = 1.0f / q;
-        a1 = 1.0f / (1.0f + g * (g + k));
-        a2 = g * a1;
-        a3 = g * a2;
+        const float a1 = 1.0f / (1.0f + g * (g + k));
+        const float a2 = g * a1;
+        const float a3 = g * a2;
+        setCoefficiants(a1, a2, a3);
     }
     
     void reset()
     {
         g = 0.0f;
         k = 0.0f;
-        a1 = 0.0f;
-        a2 = 0.0f;
-        a3 = 0.0f;
-
-        ic1eq = 0.0f;
-        ic2eq = 0.0f;
+        setCoefficiants(0.0f, 0.0f, 0.0f);
+        clearState();
         
-        m0 = 1;
-        m1 = -k;
-        m2 = -1;
+        setMix(1.0f, -k, -1.0f);
     }
 };
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    Interpolation.h
+    Created: 14 Oct 2026 9:20:37am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/**
+ The ways oscillators read between the samples of a wavetable, from the cheapest to the cleanest. Each mode has a
+ policy in InterpolationPolicies.h.
+ */
+namespace interpolation
+{
+    // Modes, as stored in the realtime and offline quality parameters
+    enum Mode
+    {
+        truncation = 0,
+        linear,
+        cubicHermite,
+        lagrange,
+        numModes
+    };
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    InterpolationPolicies.h
+    Created: 14 Oct 2026 10:02:11am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <type_traits>
+#include "Interpolation.h"
+
+/**
+ The policy of every interpolation mode, with a single interpolate() function written once for plain floats
+ (WavetableOscillator) and for the SIMD wrappers (SimdKernelSet), which makes the mode a template parameter of the
+ loops instead of a branch in them.
+
+ Every policy gets the 4 samples around the phase (x[-1], x[0], x[1] and x[2]) and the fraction between x[0] and
+ x[1], and declares in points how many of them it reads, so the others are not even fetched.
+ Formulas from Olli Niemitalo, "Polynomial Interpolators for High-Quality Resampling of Oversampled Audio".
+
+ In the files of the SIMD kernels, this must only be included after the instruction set pragmas (like
+ SimdKernelSet.h), so the policies are compiled for the instruction set of their wrapper.
+ */
+namespace interpolation
+{
+    /**
+     Returns x in the type of the samples: itself for floats, a vector holding it in every lane for SIMD wrappers.
+     */
+    template <typename T>
+    inline T broadcast(float x)
+    {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return x;
+        }
+        else {
+            return T::broadcast(x);
+        }
+    }
+
+    /**
+     Plays the sample before the phase (no interpolation). Cheapest, but its error is a staircase of the wave,
+     heard as noise and aliasing.
+     */
+    struct Truncation
+    {
+        static constexpr int points { 1 };
+
+        template <typename T>
+        static T interpolate(T, T x0, T, T, T)
+        {
+            return x0;
+        }
+    };
+
+    /**
+     Straight line between the 2 nearest samples.
+     */
+    struct Linear
+    {
+        static constexpr int points { 2 };
+
+        template <typename T>
+        static T interpolate(T, T x0, T x1, T, T fraction)
+        {
+            return (broadcast<T>(1.0f) - fraction) * x0 + fraction * x1;
+        }
+    };
+
+    /**
+     Cubic Hermite (Catmull-Rom) spline through the 4 nearest samples; its slope at every sample is the slope
+     between the samples around it, so the wave has no corners.
+     */
+    struct CubicHermite
+    {
+        static constexpr int points { 4 };
+
+        template <typename T>
+        static T interpolate(T xm1, T x0, T x1, T x2, T fraction)
+        {
+            const T half = broadcast<T>(0.5f);
+            const T c1 = half * (x1 - xm1);
+            const T c2 = xm1 - broadcast<T>(2.5f) * x0 + broadcast<T>(2.0f) * x1 - half * x2;
+            const T c3 = half * (x2 - xm1) + broadcast<T>(1.5f) * (x0 - x1);
+
+            return ((c3 * fraction + c2) * fraction + c1) * fraction + x0;
+        }
+    };
+
+    /**
+     4-point, 3rd-order Lagrange polynomial through the 4 nearest samples; the most accurate on smooth waves.
+     */
+    struct Lagrange
+    {
+        static constexpr int points { 4 };
+
+        template <typename T>
+        static T interpolate(T xm1, T x0, T x1, T x2, T fraction)
+        {
+            const T half = broadcast<T>(0.5f);
+            const T sixth = broadcast<T>(1.0f / 6.0f);
+            const T c1 = x1 - broadcast<T>(1.0f / 3.0f) * xm1 - half * x0 - sixth * x2;
+            const T c2 = half * (xm1 + x1) - x0;
+            const T c3 = sixth * (x2 - xm1) + half * (x0 - x1);
+
+            return ((c3 * fraction + c2) * fraction + c1) * fraction + x0;
+        }
+    };
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    ParallelPreparation.cpp
+    Created: 10 Oct 2026 10:31:26am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "ParallelPreparation.h"
+#include <atomic>
+#include <memory>
+
+namespace
+{
+    /**
+     The pool of every preparation of the process (one thread per core), created by the first one, so the synth
+     instances prepared afterwards don't start threads again.
+     */
+    class PreparationPool : public juce::DeletedAtShutdown
+    {
+    public:
+        juce::ThreadPool pool;
+        
+        ~PreparationPool() override { clearSingletonInstance(); }
+        
+        // LRN a DeletedAtShutdown singleton is deleted when JUCE shuts down, before the plugin is unloaded, so its
+        //  threads are not stopped during the static destruction of the library
+        JUCE_DECLARE_SINGLETON(PreparationPool, false)
+    };
+    
+    JUCE_IMPLEMENT_SINGLETON(PreparationPool)
+}
+
+void ParallelPreparation::run(int tasksCount, const std::function<void(int)>& task)
+{
+    if (tasksCount <= 0) { return; }
+    
+    juce::ThreadPool* pool = &PreparationPool::getInstance()->pool;
+    
+    // Shared with the pool's jobs, which can outlive this call if they start late and find no task left
+    struct Batch
+    {
+        std::function<void(int)> task;
+        int tasksCount;
+        std::atomic<int> nextTask { 0 };
+        std::atomic<int> doneTasks { 0 };
+        juce::WaitableEvent finished;
+    };
+    
+    auto batch = std::make_shared<Batch>();
+    batch->task = task;
+    batch->tasksCount = tasksCount;
+    
+    // Every worker takes the next task until there are none left
+    auto work = [batch] {
+        for (int i = batch->nextTask++; i < batch->tasksCount; i = batch->nextTask++) {
+            batch->task(i);
+            
+            if (++batch->doneTasks == batch->tasksCount) {
+                batch->finished.signal();
+            }
+        }
+    };
+    
+    const int helpersCount = juce::jmin(pool->getNumThreads(), tasksCount - 1);
+    
+    for (int i = 0; i < helpersCount; ++i) {
+        pool->addJob(work);
+    }
+    
+    // The calling thread works too, so the tasks complete even if the pool is busy with other instances
+    work();
+    batch->finished.wait();
+}
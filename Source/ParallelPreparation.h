@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    ParallelPreparation.h
+    Created: 10 Oct 2026 10:31:26am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+
+/**
+ This class spreads independent preparation tasks (generating tables, preparing voices...) over all the CPU cores.
+ The tasks run on a thread pool shared by every synth instance of the process, started by the first preparation and
+ kept until JUCE shuts down. It is meant for work done outside of the audio thread, like when the plugin is loaded
+ or the sample rate changes.
+ */
+class ParallelPreparation
+{
+public:
+    /**
+     Calls task(i) for every i in [0, tasksCount), spread over the pool's threads and the calling thread, and
+     returns once they are all done. The tasks must not depend on each other.
+     */
+    static void run(int tasksCount, const std::function<void(int)>& task);
+};
@@ -118,6 +118,75 @@ CppsynthAudioProcessorEditor::CppsynthAudioProcessorEditor (CppsynthAudioProcess
     addAndMakeVisible(hpfSustainKnob);
     hpfReleaseKnob.label = "Release";
     addAndMakeVisible(hpfReleaseKnob);
+    
+    // QUALITY
+    qualityLabel.setText("# QUALITY #", {});
+    qualityLabel.setJustificationType(juce::Justification::centred);
+    qualityLabel.setColour(juce::Label::textColourId, juce::Colours::greenyellow);
+    addAndMakeVisible(qualityLabel);
+    realtimeQualityKnob.label = "Realtime";
+    addAndMakeVisible(realtimeQualityKnob);
+    offlineQualityKnob.label = "Offline";
+    addAndMakeVisible(offlineQualityKnob);
+    
+    // ENGINES
+    enginesLabel.setText("# ENGINES #", {});
+    enginesLabel.setJustificationType(juce::Justification::centred);
+    enginesLabel.setColour(juce::Label::textColourId, juce::Colours::greenyellow);
+    addAndMakeVisible(enginesLabel);
+    osc1EngineKnob.label = "OSC1";
+    addAndMakeVisible(osc1EngineKnob);
+    osc2EngineKnob.label = "OSC2";
+    addAndMakeVisible(osc2EngineKnob);
+    
+    // UNISON
+    unisonLabel.setText("# UNISON #", {});
+    unisonLabel.setJustificationType(juce::Justification::centred);
+    unisonLabel.setColour(juce::Label::textColourId, juce::Colours::greenyellow);
+    addAndMakeVisible(unisonLabel);
+    unisonVoicesKnob.label = "Voices";
+    addAndMakeVisible(unisonVoicesKnob);
+    unisonDetuneKnob.label = "Detune";
+    addAndMakeVisible(unisonDetuneKnob);
+    unisonSpreadKnob.label = "Spread %";
+    addAndMakeVisible(unisonSpreadKnob);
+    
+    // FM/SYNC
+    fmLabel.setText("# FM/SYNC #", {});
+    fmLabel.setJustificationType(juce::Justification::centred);
+    fmLabel.setColour(juce::Label::textColourId, juce::Colours::greenyellow);
+    addAndMakeVisible(fmLabel);
+    fmAmountKnob.label = "Amount %";
+    addAndMakeVisible(fmAmountKnob);
+    fmOversamplingKnob.label = "Oversampling";
+    addAndMakeVisible(fmOversamplingKnob);
+    hardSyncButton.setButtonText(juce::CharPointer_UTF8("Hard Sync"));
+    hardSyncButton.setClickingTogglesState(true);
+    addAndMakeVisible(hardSyncButton);
+    
+    // ADDITIVE
+    additiveLabel.setText("# ADDITIVE #", {});
+    additiveLabel.setJustificationType(juce::Justification::centred);
+    additiveLabel.setColour(juce::Label::textColourId, juce::Colours::greenyellow);
+    addAndMakeVisible(additiveLabel);
+    additivePartialsKnob.label = "Partials";
+    addAndMakeVisible(additivePartialsKnob);
+    additiveTiltKnob.label = "Tilt";
+    addAndMakeVisible(additiveTiltKnob);
+    
+    // VOICES
+    voicesLabel.setText("# VOICES #", {});
+    voicesLabel.setJustificationType(juce::Justification::centred);
+    voicesLabel.setColour(juce::Label::textColourId, juce::Colours::greenyellow);
+    addAndMakeVisible(voicesLabel);
+    maxPolyphonyKnob.label = "Polyphony";
+    addAndMakeVisible(maxPolyphonyKnob);
+    renderThreadsKnob.label = "Threads";
+    addAndMakeVisible(renderThreadsKnob);
+    // The render threads are shared by every instance, which the knob alone doesn't tell
+    renderThreadsNote.setText("Threads are shared by all instances: while another one uses them, this one renders on 1 thread", {});
+    renderThreadsNote.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(renderThreadsNote);
 
     // Toggles
     polyModeButton.setButtonText(juce::CharPointer_UTF8("Poly"));
@@ -152,7 +221,7 @@ CppsynthAudioProcessorEditor::CppsynthAudioProcessorEditor (CppsynthAudioProcess
     addAndMakeVisible(titleLabel);
     
     // Plugin size
-    setSize(1100, 550);
+    setSize(1100, 840);
 }
 
 CppsynthAudioProcessorEditor::~CppsynthAudioProcessorEditor()
@@ -187,7 +256,24 @@ void CppsynthAudioProcessorEditor::resized()
     juce::Rectangle masterLabelPos(930, 10, 120, 40);
     juce::Rectangle masterElem(900, 60, 80, 100);
     juce::Rectangle lastColElem(995, 60, 80, 100);
-    juce::Rectangle titleLabelPos(950, 375, 80, 200);
+    juce::Rectangle titleLabelPos(950, 375, 80, 160);
+    // Second row of sections, for the oscillator engines and the voices
+    juce::Rectangle qualityLabelPos(20, 550, 80, 40);
+    juce::Rectangle qualityElem(20, 600, 80, 100);
+    juce::Rectangle enginesLabelPos(140, 550, 80, 40);
+    juce::Rectangle enginesElem(140, 600, 80, 100);
+    juce::Rectangle unisonLabelPos(280, 550, 120, 40);
+    juce::Rectangle unisonElem(260, 600, 80, 100);
+    juce::Rectangle unisonSecondElem(345, 600, 80, 100);
+    juce::Rectangle fmLabelPos(520, 550, 120, 40);
+    juce::Rectangle fmElem(500, 600, 80, 100);
+    juce::Rectangle fmSecondElem(585, 600, 80, 100);
+    juce::Rectangle additiveLabelPos(710, 550, 120, 40);
+    juce::Rectangle additiveElem(695, 600, 80, 100);
+    juce::Rectangle additiveSecondElem(780, 600, 80, 100);
+    juce::Rectangle voicesLabelPos(930, 550, 120, 40);
+    juce::Rectangle voicesElem(900, 600, 80, 100);
+    juce::Rectangle voicesSecondElem(995, 600, 80, 100);
     
     // OSC1
     osc1Label.setBounds(osc1LabelPos);
@@ -287,6 +373,54 @@ void CppsynthAudioProcessorEditor::resized()
     masterElem = masterElem.withY(masterElem.getBottom() + 20);
     
     titleLabel.setBounds(titleLabelPos);
+    
+    // Quality
+    qualityLabel.setBounds(qualityLabelPos);
+    realtimeQualityKnob.setBounds(qualityElem);
+    qualityElem = qualityElem.withY(qualityElem.getBottom() + 20);
+    offlineQualityKnob.setBounds(qualityElem);
+    qualityElem = qualityElem.withY(qualityElem.getBottom() + 20);
+    
+    // Engines
+    enginesLabel.setBounds(enginesLabelPos);
+    osc1EngineKnob.setBounds(enginesElem);
+    enginesElem = enginesElem.withY(enginesElem.getBottom() + 20);
+    osc2EngineKnob.setBounds(enginesElem);
+    enginesElem = enginesElem.withY(enginesElem.getBottom() + 20);
+    
+    // Unison
+    unisonLabel.setBounds(unisonLabelPos);
+    unisonVoicesKnob.setBounds(unisonElem);
+    unisonElem = unisonElem.withY(unisonElem.getBottom() + 20);
+    unisonSpreadKnob.setBounds(unisonElem);
+    unisonElem = unisonElem.withY(unisonElem.getBottom() + 20);
+    unisonDetuneKnob.setBounds(unisonSecondElem);
+    unisonSecondElem = unisonSecondElem.withY(unisonSecondElem.getBottom() + 20);
+    
+    // FM/Sync
+    fmLabel.setBounds(fmLabelPos);
+    fmAmountKnob.setBounds(fmElem);
+    fmElem = fmElem.withY(fmElem.getBottom() + 20);
+    hardSyncButton.setBounds(fmElem);
+    fmElem = fmElem.withY(fmElem.getBottom() + 20);
+    fmOversamplingKnob.setBounds(fmSecondElem);
+    fmSecondElem = fmSecondElem.withY(fmSecondElem.getBottom() + 20);
+    
+    // Additive
+    additiveLabel.setBounds(additiveLabelPos);
+    additivePartialsKnob.setBounds(additiveElem);
+    additiveElem = additiveElem.withY(additiveElem.getBottom() + 20);
+    additiveTiltKnob.setBounds(additiveSecondElem);
+    additiveSecondElem = additiveSecondElem.withY(additiveSecondElem.getBottom() + 20);
+    
+    // Voices
+    voicesLabel.setBounds(voicesLabelPos);
+    maxPolyphonyKnob.setBounds(voicesElem);
+    voicesElem = voicesElem.withY(voicesElem.getBottom() + 20);
+    renderThreadsKnob.setBounds(voicesSecondElem);
+    voicesSecondElem = voicesSecondElem.withY(voicesSecondElem.getBottom() + 20);
+    // The note spans both columns, under the knobs
+    renderThreadsNote.setBounds(voicesElem.withWidth(voicesSecondElem.getRight() - voicesElem.getX()));
 
     // Other settings
     polyModeButton.setBounds(lastColElem);
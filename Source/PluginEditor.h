@@ -46,6 +46,13 @@ private:
     juce::Label lpfLabel;
     juce::Label hpfLabel;
     juce::Label masterLabel;
+    juce::Label qualityLabel;
+    juce::Label unisonLabel;
+    juce::Label enginesLabel;
+    juce::Label fmLabel;
+    juce::Label additiveLabel;
+    juce::Label voicesLabel;
+    juce::Label renderThreadsNote;
     juce::Label titleLabel;
     
     // LRN using here is used to set shortcut for class names (aliasing)
@@ -138,6 +145,46 @@ private:
     SliderAttachment lfoRateAttachment { audioProcessor.apvts, ParameterID::lfoRate.getParamID(), lfoRateKnob.slider };
     RotaryKnob vibratoKnob;
     SliderAttachment vibratoAttachment { audioProcessor.apvts, ParameterID::vibrato.getParamID(), vibratoKnob.slider };
+    
+    // QUALITY (choices show as the knob's text)
+    RotaryKnob realtimeQualityKnob;
+    SliderAttachment realtimeQualityAttachment { audioProcessor.apvts, ParameterID::realtimeQuality.getParamID(), realtimeQualityKnob.slider };
+    RotaryKnob offlineQualityKnob;
+    SliderAttachment offlineQualityAttachment { audioProcessor.apvts, ParameterID::offlineQuality.getParamID(), offlineQualityKnob.slider };
+    
+    // ENGINES
+    RotaryKnob osc1EngineKnob;
+    SliderAttachment osc1EngineAttachment { audioProcessor.apvts, ParameterID::osc1Engine.getParamID(), osc1EngineKnob.slider };
+    RotaryKnob osc2EngineKnob;
+    SliderAttachment osc2EngineAttachment { audioProcessor.apvts, ParameterID::osc2Engine.getParamID(), osc2EngineKnob.slider };
+    
+    // UNISON
+    RotaryKnob unisonVoicesKnob;
+    SliderAttachment unisonVoicesAttachment { audioProcessor.apvts, ParameterID::unisonVoices.getParamID(), unisonVoicesKnob.slider };
+    RotaryKnob unisonDetuneKnob;
+    SliderAttachment unisonDetuneAttachment { audioProcessor.apvts, ParameterID::unisonDetune.getParamID(), unisonDetuneKnob.slider };
+    RotaryKnob unisonSpreadKnob;
+    SliderAttachment unisonSpreadAttachment { audioProcessor.apvts, ParameterID::unisonSpread.getParamID(), unisonSpreadKnob.slider };
+    
+    // FM/SYNC
+    RotaryKnob fmAmountKnob;
+    SliderAttachment fmAmountAttachment { audioProcessor.apvts, ParameterID::fmAmount.getParamID(), fmAmountKnob.slider };
+    RotaryKnob fmOversamplingKnob;
+    SliderAttachment fmOversamplingAttachment { audioProcessor.apvts, ParameterID::fmOversampling.getParamID(), fmOversamplingKnob.slider };
+    juce::TextButton hardSyncButton;
+    ButtonAttachment hardSyncAttachment { audioProcessor.apvts, ParameterID::hardSync.getParamID(), hardSyncButton };
+    
+    // ADDITIVE
+    RotaryKnob additivePartialsKnob;
+    SliderAttachment additivePartialsAttachment { audioProcessor.apvts, ParameterID::additivePartials.getParamID(), additivePartialsKnob.slider };
+    RotaryKnob additiveTiltKnob;
+    SliderAttachment additiveTiltAttachment { audioProcessor.apvts, ParameterID::additiveTilt.getParamID(), additiveTiltKnob.slider };
+    
+    // VOICES
+    RotaryKnob maxPolyphonyKnob;
+    SliderAttachment maxPolyphonyAttachment { audioProcessor.apvts, ParameterID::maxPolyphony.getParamID(), maxPolyphonyKnob.slider };
+    RotaryKnob renderThreadsKnob;
+    SliderAttachment renderThreadsAttachment { audioProcessor.apvts, ParameterID::renderThreads.getParamID(), renderThreadsKnob.slider };
 
     // Toggles
     juce::TextButton polyModeButton;
@@ -34,6 +34,16 @@ CppsynthAudioProcessor::CppsynthAudioProcessor()
     castJuceParameter(apvts, ParameterID::oscFine, oscFineParam);
     castJuceParameter(apvts, ParameterID::osc1Morph, osc1MorphParam);
     castJuceParameter(apvts, ParameterID::osc2Morph, osc2MorphParam);
+    castJuceParameter(apvts, ParameterID::osc1Engine, osc1EngineParam);
+    castJuceParameter(apvts, ParameterID::osc2Engine, osc2EngineParam);
+    castJuceParameter(apvts, ParameterID::unisonVoices, unisonVoicesParam);
+    castJuceParameter(apvts, ParameterID::unisonDetune, unisonDetuneParam);
+    castJuceParameter(apvts, ParameterID::unisonSpread, unisonSpreadParam);
+    castJuceParameter(apvts, ParameterID::fmAmount, fmAmountParam);
+    castJuceParameter(apvts, ParameterID::fmOversampling, fmOversamplingParam);
+    castJuceParameter(apvts, ParameterID::hardSync, hardSyncParam);
+    castJuceParameter(apvts, ParameterID::additivePartials, additivePartialsParam);
+    castJuceParameter(apvts, ParameterID::additiveTilt, additiveTiltParam);
 //    castJuceParameter(apvts, ParameterID::glideMode, glideModeParam);
 //    castJuceParameter(apvts, ParameterID::glideRate, glideRateParam);
 //    castJuceParameter(apvts, ParameterID::glideBend, glideBendParam);
@@ -63,10 +73,14 @@ CppsynthAudioProcessor::CppsynthAudioProcessor()
     castJuceParameter(apvts, ParameterID::tuning, tuningParam);
     castJuceParameter(apvts, ParameterID::outputLevel, outputLevelParam);
     castJuceParameter(apvts, ParameterID::polyMode, polyModeParam);
+    castJuceParameter(apvts, ParameterID::maxPolyphony, maxPolyphonyParam);
+    castJuceParameter(apvts, ParameterID::renderThreads, renderThreadsParam);
     castJuceParameter(apvts, ParameterID::velocitySensitivity, velocitySensitivityParam);
     castJuceParameter(apvts, ParameterID::noiseType, noiseTypeParam);
     castJuceParameter(apvts, ParameterID::ringMod, ringModParam);
     castJuceParameter(apvts, ParameterID::phaseRand, phaseRandParam);
+    castJuceParameter(apvts, ParameterID::realtimeQuality, realtimeQualityParam);
+    castJuceParameter(apvts, ParameterID::offlineQuality, offlineQualityParam);
     
     // Add listener for parameter changes
     apvts.state.addListener(this);
@@ -143,6 +157,7 @@ void CppsynthAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 {
     // Pass sample rate to synth
     synth.allocateResources(sampleRate, samplesPerBlock);
+    synth.prepareRenderThreads(renderThreadsParam->get());
     parametersChanged.store(true); // force update() to be executed
     reset();
 }
@@ -161,6 +176,14 @@ void CppsynthAudioProcessor::reset()
     synth.outputLevelSmoother.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(outputLevelParam->get()));
 }
 
+void CppsynthAudioProcessor::setNonRealtime(bool nonRealtime) noexcept
+{
+    juce::AudioProcessor::setNonRealtime(nonRealtime);
+    
+    // The oscillators switch to the quality of the new render mode on the next block
+    parametersChanged.store(true);
+}
+
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool CppsynthAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -354,6 +377,26 @@ juce::AudioProcessorValueTreeState::ParameterLayout CppsynthAudioProcessor::crea
                                                             "Polyphony",
                                                             juce::StringArray { "Mono", "Poly" },
                                                             1));
+    
+    // Most voices playing at once in poly mode; every voice is allocated beforehand, so this changes freely. A
+    //  voice count is a setting of the patch, not something to automate
+    layout.add(std::make_unique<juce::AudioParameterInt>(ParameterID::maxPolyphony,
+                                                         "Max Polyphony",
+                                                         1,
+                                                         constants::MAX_VOICES,
+                                                         constants::DEFAULT_POLYPHONY,
+                                                         juce::AudioParameterIntAttributes().withAutomatable(false)));
+    
+    // Threads rendering the voices; above 1, the voices are spread over the cores (as many as the machine has).
+    //  It is a setting of the session, not something to automate. The worker threads are shared by every instance
+    //  of the synth: an instance whose block comes while they render another one's renders on its audio thread
+    //  alone, so only one instance at a time gets the speedup (the editor says so next to the control)
+    layout.add(std::make_unique<juce::AudioParameterInt>(ParameterID::renderThreads,
+                                                         "Render Threads",
+                                                         1,
+                                                         constants::MAX_RENDER_THREADS,
+                                                         1,
+                                                         juce::AudioParameterIntAttributes().withAutomatable(false)));
         
     // Velocity sensitivity toggle
     layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::velocitySensitivity,
@@ -372,6 +415,17 @@ juce::AudioProcessorValueTreeState::ParameterLayout CppsynthAudioProcessor::crea
                                                             juce::StringArray { "Off", "On" },
                                                             0));
     
+    // Oscillator interpolation while playing live (cheap) and while bouncing offline (clean), in the order of
+    //  interpolation::Mode
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::realtimeQuality,
+                                                            "Realtime Quality",
+                                                            juce::StringArray { "Truncation", "Linear", "Cubic Hermite", "Lagrange" },
+                                                            interpolation::linear));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::offlineQuality,
+                                                            "Offline Quality",
+                                                            juce::StringArray { "Truncation", "Linear", "Cubic Hermite", "Lagrange" },
+                                                            interpolation::lagrange));
+    
     // OSC tune in semitones
     layout.add(std::make_unique<juce::AudioParameterFloat>(ParameterID::oscTune, 
                                                            "OSC2 Semitones",
@@ -415,6 +469,66 @@ juce::AudioProcessorValueTreeState::ParameterLayout CppsynthAudioProcessor::crea
                                                            juce::NormalisableRange<float>(0.f, 0.999f, 0.001f),
                                                            0.999f,
                                                            juce::AudioParameterFloatAttributes()));
+    
+    // Oscillator engines, in the order of oscillatorEngine::Engine
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::osc1Engine,
+                                                            "OSC1 Engine",
+                                                            juce::StringArray { "Wavetable", "PolyBLEP", "Additive" },
+                                                            oscillatorEngine::wavetable));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::osc2Engine,
+                                                            "OSC2 Engine",
+                                                            juce::StringArray { "Wavetable", "PolyBLEP", "Additive" },
+                                                            oscillatorEngine::wavetable));
+    
+    // Unison copies of both oscillators in every voice
+    layout.add(std::make_unique<juce::AudioParameterInt>(ParameterID::unisonVoices,
+                                                         "Unison Voices",
+                                                         1,
+                                                         constants::MAX_UNISON,
+                                                         1));
+    
+    // Detuning of the outermost unison copies, up and down from the note
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ParameterID::unisonDetune,
+                                                           "Unison Detune",
+                                                           juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f),
+                                                           20.0f,
+                                                           juce::AudioParameterFloatAttributes().withLabel("cent")));
+    
+    // Stereo width of the unison copies
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ParameterID::unisonSpread,
+                                                           "Unison Spread",
+                                                           juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f),
+                                                           50.0f,
+                                                           juce::AudioParameterFloatAttributes().withLabel("%")));
+    
+    // Phase modulation of OSC1 by OSC2 (wavetable engine only), and how much it is oversampled against aliasing
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ParameterID::fmAmount,
+                                                           "FM Amount",
+                                                           juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f),
+                                                           0.0f,
+                                                           juce::AudioParameterFloatAttributes().withLabel("%")));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::fmOversampling,
+                                                            "FM Oversampling",
+                                                            juce::StringArray { "1x", "2x", "4x" },
+                                                            1));
+    
+    // Hard sync of OSC2 to OSC1 (when OSC2 uses the wavetable engine); it replaces the phase modulation
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::hardSync,
+                                                            "Hard Sync",
+                                                            juce::StringArray { "Off", "On" },
+                                                            0));
+    
+    // Partials of the additive engine: how many, and how much quieter the upper ones get
+    layout.add(std::make_unique<juce::AudioParameterInt>(ParameterID::additivePartials,
+                                                         "Additive Partials",
+                                                         1,
+                                                         constants::MAX_PARTIALS,
+                                                         constants::MAX_PARTIALS));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ParameterID::additiveTilt,
+                                                           "Additive Tilt",
+                                                           juce::NormalisableRange<float>(-12.0f, 0.0f, 0.1f),
+                                                           0.0f,
+                                                           juce::AudioParameterFloatAttributes().withLabel("dB/oct")));
 
     // Noise type
     layout.add(std::make_unique<juce::AudioParameterChoice>(ParameterID::noiseType,
@@ -634,6 +748,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout CppsynthAudioProcessor::crea
 void CppsynthAudioProcessor::valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&)
 {
     // DBG("parameter changed");
+    // Called on the message thread, so the render workers can be started here when more threads are asked for
+    synth.prepareRenderThreads(renderThreadsParam->get());
     parametersChanged.store(true);
 }
 
@@ -691,9 +807,31 @@ void CppsynthAudioProcessor::update()
     // OSC morph
     synth.osc1Morph = osc1MorphParam->get();
     synth.osc2Morph = osc2MorphParam->get();
+    
+    // OSC engines
+    synth.osc1Engine = static_cast<oscillatorEngine::Engine>(osc1EngineParam->getIndex());
+    synth.osc2Engine = static_cast<oscillatorEngine::Engine>(osc2EngineParam->getIndex());
+    
+    // Unison
+    synth.unison = unisonVoicesParam->get();
+    synth.unisonDetune = unisonDetuneParam->get();
+    synth.unisonSpread = unisonSpreadParam->get() / 100.0f;
+    
+    // Phase modulation
+    synth.fmAmount = fmAmountParam->get() / 100.0f;
+    synth.fmOversampling = 1 << fmOversamplingParam->getIndex();
+    
+    // Hard sync
+    synth.hardSync = (hardSyncParam->getIndex() == 0 ? false : true);
+    
+    // Additive engine
+    synth.additivePartials = additivePartialsParam->get();
+    synth.additiveTilt = additiveTiltParam->get();
         
     // Mono/unisson/poly mode
     synth.polyMode = polyModeParam->getIndex();
+    synth.maxPolyphony = maxPolyphonyParam->get();
+    synth.renderThreads = renderThreadsParam->get();
     
     // Noise type
     synth.noiseType = noiseTypeParam->getIndex();
@@ -723,6 +861,10 @@ void CppsynthAudioProcessor::update()
     // Phase randomizer on new notes
     synth.phaseRand = (phaseRandParam->getIndex() == 0 ? false : true);
     
+    // Oscillator interpolation for the current render mode
+    auto* qualityParam = (isNonRealtime() ? offlineQualityParam : realtimeQualityParam);
+    synth.interpolationMode = static_cast<interpolation::Mode>(qualityParam->getIndex());
+    
     // LFO
     // Skew parameter value to 0.02Hz-20Hz approx.
     float lfoRate = std::exp(7.0f * lfoRateParam->get() - 4.0f);
@@ -24,6 +24,16 @@ namespace ParameterID
     PARAMETER_ID(oscFine)
     PARAMETER_ID(osc1Morph)
     PARAMETER_ID(osc2Morph)
+    PARAMETER_ID(osc1Engine)
+    PARAMETER_ID(osc2Engine)
+    PARAMETER_ID(unisonVoices)
+    PARAMETER_ID(unisonDetune)
+    PARAMETER_ID(unisonSpread)
+    PARAMETER_ID(fmAmount)
+    PARAMETER_ID(fmOversampling)
+    PARAMETER_ID(hardSync)
+    PARAMETER_ID(additivePartials)
+    PARAMETER_ID(additiveTilt)
 //    PARAMETER_ID(glideMode)
 //    PARAMETER_ID(glideRate)
 //    PARAMETER_ID(glideBend)
@@ -53,10 +63,14 @@ namespace ParameterID
     PARAMETER_ID(tuning)
     PARAMETER_ID(outputLevel)
     PARAMETER_ID(polyMode)
+    PARAMETER_ID(maxPolyphony)
+    PARAMETER_ID(renderThreads)
     PARAMETER_ID(velocitySensitivity)
     PARAMETER_ID(noiseType)
     PARAMETER_ID(ringMod)
     PARAMETER_ID(phaseRand)
+    PARAMETER_ID(realtimeQuality)
+    PARAMETER_ID(offlineQuality)
 
     #undef PARAMETER_ID
 }
@@ -83,6 +97,9 @@ public:
     void releaseResources() override;
     
     void reset() override;
+    
+    // LRN the host switches to non-realtime mode for offline bounces, where quality matters more than CPU
+    void setNonRealtime(bool nonRealtime) noexcept override;
 
     // LRN #conditionals are preprocessor directives (before compilation)
    #ifndef JucePlugin_PreferredChannelConfigurations
@@ -125,6 +142,16 @@ private:
     juce::AudioParameterFloat* oscFineParam;
     juce::AudioParameterFloat* osc1MorphParam;
     juce::AudioParameterFloat* osc2MorphParam;
+    juce::AudioParameterChoice* osc1EngineParam;
+    juce::AudioParameterChoice* osc2EngineParam;
+    juce::AudioParameterInt* unisonVoicesParam;
+    juce::AudioParameterFloat* unisonDetuneParam;
+    juce::AudioParameterFloat* unisonSpreadParam;
+    juce::AudioParameterFloat* fmAmountParam;
+    juce::AudioParameterChoice* fmOversamplingParam;
+    juce::AudioParameterChoice* hardSyncParam;
+    juce::AudioParameterInt* additivePartialsParam;
+    juce::AudioParameterFloat* additiveTiltParam;
 //    juce::AudioParameterChoice* glideModeParam;
 //    juce::AudioParameterFloat* glideRateParam;
 //    juce::AudioParameterFloat* glideBendParam;
@@ -154,10 +181,14 @@ private:
     juce::AudioParameterFloat* tuningParam;
     juce::AudioParameterFloat* outputLevelParam;
     juce::AudioParameterChoice* polyModeParam;
+    juce::AudioParameterInt* maxPolyphonyParam;
+    juce::AudioParameterInt* renderThreadsParam;
     juce::AudioParameterChoice* velocitySensitivityParam;
     juce::AudioParameterChoice* noiseTypeParam;
     juce::AudioParameterChoice* ringModParam;
     juce::AudioParameterChoice* phaseRandParam;
+    juce::AudioParameterChoice* realtimeQualityParam;
+    juce::AudioParameterChoice* offlineQualityParam;
     
     // Atomic (thread-safe) flag to signal a parameter change
     std::atomic<bool> parametersChanged { false };
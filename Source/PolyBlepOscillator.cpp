@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    PolyBlepOscillator.cpp
+    Created: 15 Oct 2026 9:41:06am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "PolyBlepOscillator.h"
+#include <algorithm>
+
+namespace
+{
+    // Periods per unit of the fixed-point phase
+    constexpr float phaseScale { 1.0f / 4294967296.0f };
+
+    /**
+     Returns the distance from a position in the period to samplePhase, in periods, between -0.5 and 0.5.
+     LRN the difference of two fixed-point phases wraps around the period, and reading it as a signed integer
+     gives the shortest way between them, with all the precision of the phase near the position
+     */
+    float getDistance(uint32_t samplePhase, uint32_t position)
+    {
+        return static_cast<float>(static_cast<int32_t>(samplePhase - position)) * phaseScale;
+    }
+
+    /**
+     Correction of a jump of 2 (from -1 to 1) at distance from the sample, for a phase increment of increment
+     periods per sample: the difference between a band-limited step, approximated by a polynomial over the two
+     samples around the jump, and the naive step.
+     */
+    float polyBlep(float distance, float increment)
+    {
+        if (distance >= 0.0f && distance < increment) {
+            const float x = distance / increment;
+            return x + x - x * x - 1.0f;
+        }
+
+        if (distance < 0.0f && distance > -increment) {
+            const float x = distance / increment;
+            return x * x + x + x + 1.0f;
+        }
+
+        return 0.0f;
+    }
+
+    /**
+     Correction of a change of slope of 1 (per period) at distance from the sample, for the corners of the triangle:
+     the correction of a jump of 1 (half of polyBlep()) integrated over the samples, times the slope change per
+     sample.
+     */
+    float polyBlamp(float distance, float increment)
+    {
+        if (distance >= 0.0f && distance < increment) {
+            const float x = 1.0f - distance / increment;
+            return x * x * x * increment * (1.0f / 6.0f);
+        }
+
+        if (distance < 0.0f && distance > -increment) {
+            const float x = 1.0f + distance / increment;
+            return x * x * x * increment * (1.0f / 6.0f);
+        }
+
+        return 0.0f;
+    }
+}
+
+PolyBlepOscillator::PolyBlepOscillator(float sampleRate) : sampleRate{ sampleRate } {}
+
+void PolyBlepOscillator::setSampleRate(float newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+void PolyBlepOscillator::setPhase(uint32_t newPhase)
+{
+    phase = newPhase;
+}
+
+uint32_t PolyBlepOscillator::getPhase() const
+{
+    return phase;
+}
+
+void PolyBlepOscillator::setFrequency(float frequency)
+{
+    // Same as WavetableOscillator::setFrequency(), so both engines play exactly the same pitch
+    phaseIncrement = static_cast<uint32_t>(static_cast<int64_t>(static_cast<double>(frequency) / sampleRate * 4294967296.0));
+}
+
+void PolyBlepOscillator::setMorph(float morph)
+{
+    // Same morph positions as the frames of WavetableOscillator
+    const float framePosition = std::clamp(morph, 0.0f, 1.0f) / constants::MORPH_FRAME_WIDTH;
+    morphFrame = std::min(static_cast<int>(framePosition), WavetableBank::numShapes - 2);
+    nextMorphFrameWeight = framePosition - static_cast<float>(morphFrame);
+}
+
+template <WavetableBank::Shape shape>
+float PolyBlepOscillator::getSample(uint32_t samplePhase, float increment)
+{
+    // The shapes have the polarity and the phase of the bank's tables, so both engines sound the same
+    if constexpr (shape == WavetableBank::sine) {
+        // Folded to [-1/4, 1/4] of a period, where an odd polynomial (Taylor series to x^11) is accurate to float
+        //  precision; a sine has no harmonic to alias
+        float position = static_cast<float>(static_cast<int32_t>(samplePhase)) * phaseScale;
+
+        if (position > 0.25f) {
+            position = 0.5f - position;
+        }
+        else if (position < -0.25f) {
+            position = -0.5f - position;
+        }
+
+        const float x = position * constants::TWO_PI;
+        const float x2 = x * x;
+
+        return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f
+                  + x2 * (1.0f / 362880.0f - x2 * (1.0f / 39916800.0f))))));
+    }
+    else if constexpr (shape == WavetableBank::triangle) {
+        // Goes down from 0 to -1 at a quarter of the period, up to 1 at three quarters; the slope changes by 8 at
+        //  each corner
+        const float shifted = static_cast<float>(samplePhase + 0x40000000u) * phaseScale;
+
+        return 4.0f * std::abs(shifted - 0.5f) - 1.0f
+             + 8.0f * polyBlamp(getDistance(samplePhase, 0x40000000u), increment)
+             - 8.0f * polyBlamp(getDistance(samplePhase, 0xC0000000u), increment);
+    }
+    else if constexpr (shape == WavetableBank::square) {
+        // 1 on the first half of the period, -1 on the second
+        return (samplePhase < 0x80000000u ? 1.0f : -1.0f)
+             + polyBlep(getDistance(samplePhase, 0u), increment)
+             - polyBlep(getDistance(samplePhase, 0x80000000u), increment);
+    }
+    else {
+        // Goes down from 0, jumps from -1 to 1 at half the period and comes back down to 0
+        return 1.0f - 2.0f * static_cast<float>(samplePhase + 0x80000000u) * phaseScale
+             + polyBlep(getDistance(samplePhase, 0x80000000u), increment);
+    }
+}
+
+void PolyBlepOscillator::renderBlock(float* out, int numSamples, const float* phaseIncMod)
+{
+    // The morph is checked once per block; each pair of shapes has its own loop
+    switch (morphFrame) {
+        case WavetableBank::sine:
+            renderBlockWith<WavetableBank::sine>(out, numSamples, phaseIncMod);
+            break;
+        case WavetableBank::triangle:
+            renderBlockWith<WavetableBank::triangle>(out, numSamples, phaseIncMod);
+            break;
+        default:
+            renderBlockWith<WavetableBank::square>(out, numSamples, phaseIncMod);
+            break;
+    }
+}
+
+template <WavetableBank::Shape shape>
+void PolyBlepOscillator::renderBlockWith(float* out, int numSamples, const float* phaseIncMod)
+{
+    constexpr auto nextShape = static_cast<WavetableBank::Shape>(shape + 1);
+    const uint32_t startPhase = phase;
+    const uint32_t increment = phaseIncrement;
+
+    if (phaseIncMod == nullptr) {
+        const float periodIncrement = static_cast<float>(increment) * phaseScale;
+
+        for (int i = 0; i < numSamples; ++i) {
+            const uint32_t samplePhase = startPhase + static_cast<uint32_t>(i) * increment;
+            const float sample = getSample<shape>(samplePhase, periodIncrement);
+            const float nextSample = getSample<nextShape>(samplePhase, periodIncrement);
+            out[i] = sample + (nextSample - sample) * nextMorphFrameWeight;
+        }
+
+        phase = startPhase + static_cast<uint32_t>(numSamples) * increment;
+    }
+    else {
+        uint32_t samplePhase = startPhase;
+
+        for (int i = 0; i < numSamples; ++i) {
+            // The corrections span the current increment, modulated or not
+            const uint32_t sampleIncrement = static_cast<uint32_t>(static_cast<int64_t>(static_cast<float>(increment) * phaseIncMod[i]));
+            const float periodIncrement = static_cast<float>(sampleIncrement) * phaseScale;
+            const float sample = getSample<shape>(samplePhase, periodIncrement);
+            const float nextSample = getSample<nextShape>(samplePhase, periodIncrement);
+            out[i] = sample + (nextSample - sample) * nextMorphFrameWeight;
+            samplePhase += sampleIncrement;
+        }
+
+        phase = samplePhase;
+    }
+}
+
+void PolyBlepOscillator::stop(bool phaseRand)
+{
+    // Starting phase of the oscillator will be randomized on the next note if phaseRand is activated, at the same
+    //  positions as WavetableOscillator
+    phase = (phaseRand ? static_cast<uint32_t>(rand() % constants::WAVETABLE_LENGTH) << (32 - constants::WAVETABLE_LENGTH_BITS) : 0u);
+    phaseIncrement = 0;
+}
+
+bool PolyBlepOscillator::isPlaying()
+{
+    return phaseIncrement != 0;
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    PolyBlepOscillator.h
+    Created: 15 Oct 2026 9:41:06am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include "Constants.h"
+#include "WavetableBank.h"
+
+/**
+ The engines an oscillator can play with, as stored in the engine parameters.
+ */
+namespace oscillatorEngine
+{
+    enum Engine
+    {
+        wavetable = 0,
+        polyBlep,
+        additive,
+        numEngines
+    };
+}
+
+/**
+ This class represents an oscillator that computes its wave shapes instead of reading them from tables. The naive
+ triangle, square and saw are corrected around each corner and jump with a short polynomial (PolyBLAMP and PolyBLEP),
+ which removes most of their aliasing. It uses no memory, keeps every harmonic of high notes (where the wavetables
+ only have a few), and costs the same at any sample rate.
+ It plays the same shapes, with the same phase and morph, as WavetableOscillator, and has the same interface.
+ Formulas from Välimäki, Pekonen and Nam, "Perceptually informed synthesis of bandlimited classical waveforms
+ using integrated polynomial interpolation".
+ */
+class PolyBlepOscillator
+{
+public:
+    float initFrequency = 0; // Original frequency before modulation
+
+    PolyBlepOscillator(float sampleRate);
+
+    /**
+     Changes the sample rate. The frequency must be set again after this.
+     */
+    void setSampleRate(float newSampleRate);
+
+    /**
+     Moves the phase to a position in the period, in 32-bit fixed point (2^32 is a full period).
+     */
+    void setPhase(uint32_t newPhase);
+
+    /**
+     Returns the position in the period, in 32-bit fixed point.
+     */
+    uint32_t getPhase() const;
+
+    /**
+     Calculates the phaseIncrement according to the desired frequency in Hz.
+     */
+    void setFrequency(float frequency);
+
+    /**
+     Sets the morph position, between 0 (sine) and 1 (saw).
+     */
+    void setMorph(float morph);
+
+    /**
+     Renders the next numSamples samples of the oscillator in out. phaseIncMod holds a multiplier of the phase
+     increment for every sample (audio-rate frequency modulation), or is nullptr to play at the set frequency.
+     */
+    void renderBlock(float* out, int numSamples, const float* phaseIncMod);
+
+    /**
+     Stops playback and resets phase/phase increment. The starting phase can be randomized.
+     */
+    void stop(bool phaseRand);
+
+    /**
+     Returns true if the oscillator is playing.
+     */
+    bool isPlaying();
+
+private:
+    float sampleRate;
+
+    // Same fixed-point phase as WavetableOscillator
+    uint32_t phase = 0;
+    uint32_t phaseIncrement = 0;
+
+    int morphFrame = 0; // shape before the morph position
+    float nextMorphFrameWeight = 0.0f; // position between morphFrame and the next shape
+
+    /**
+     Returns a sample of a shape at samplePhase, for a phase increment of increment periods per sample.
+     */
+    template <WavetableBank::Shape shape>
+    static float getSample(uint32_t samplePhase, float increment);
+
+    /**
+     renderBlock() for the morph between shape and the next one.
+     */
+    template <WavetableBank::Shape shape>
+    void renderBlockWith(float* out, int numSamples, const float* phaseIncMod);
+};
@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerPool.cpp
+    Created: 17 Oct 2026 9:42:18am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "RealtimeWorkerPool.h"
+#include <algorithm>
+
+#if JUCE_LINUX || JUCE_ANDROID
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#elif JUCE_MAC || JUCE_IOS
+// The futex of Apple's kernel, the one libc++ waits on for std::atomic::wait()
+extern "C" int __ulock_wait(uint32_t operation, void* address, uint64_t value, uint32_t timeout);
+extern "C" int __ulock_wake(uint32_t operation, void* address, uint64_t wakeValue);
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #pragma comment(lib, "Synchronization.lib")
+#endif
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace
+{
+    /**
+     Sleeps while word holds value; may return early, so the caller checks again.
+     */
+    void waitWhileEqual(std::atomic<uint32_t>& word, uint32_t value)
+    {
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The futex is the atomic itself");
+
+       #if JUCE_LINUX || JUCE_ANDROID
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+       #elif JUCE_MAC || JUCE_IOS
+        constexpr uint32_t compareAndWait { 1 };
+        __ulock_wait(compareAndWait, &word, value, 0);
+       #elif JUCE_WINDOWS
+        WaitOnAddress(&word, &value, sizeof(value), INFINITE);
+       #else
+        if (word.load() == value) { juce::Thread::sleep(1); }
+       #endif
+    }
+
+    /**
+     Wakes every thread sleeping on word.
+     */
+    void wakeAll(std::atomic<uint32_t>& word)
+    {
+       #if JUCE_LINUX || JUCE_ANDROID
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+       #elif JUCE_MAC || JUCE_IOS
+        constexpr uint32_t compareAndWaitWakeAll { 1 | 0x100 };
+        __ulock_wake(compareAndWaitWakeAll, &word, 0);
+       #elif JUCE_WINDOWS
+        WakeByAddressAll(&word);
+       #else
+        juce::ignoreUnused(word);
+       #endif
+    }
+
+    /**
+     Tells the processor this thread is spinning, so it spends less power and leaves the core to its other thread.
+     */
+    inline void spinPause()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (defined(__GNUC__) || defined(__clang__))
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+}
+
+RealtimeWorkerPool::Worker::Worker(RealtimeWorkerPool& pool_, int index_)
+    : juce::Thread("cppsynth render worker " + juce::String(index_ + 1)), pool(pool_), index(index_)
+{
+}
+
+void RealtimeWorkerPool::Worker::run()
+{
+    pool.work(index);
+}
+
+RealtimeWorkerPool::RealtimeWorkerPool()
+    : RealtimeWorkerPool(std::max(std::min(juce::SystemStats::getNumPhysicalCpus(), constants::MAX_RENDER_THREADS) - 1, 0))
+{
+}
+
+RealtimeWorkerPool::RealtimeWorkerPool(int workersCount)
+    : workersLimit(std::max(workersCount, 0))
+{
+}
+
+void RealtimeWorkerPool::startWorkers()
+{
+    const juce::ScopedLock lock(startLock);
+
+    if (!workers.empty()) { return; }
+
+    for (int w = 0; w < workersLimit; ++w) {
+        workers.push_back(std::make_unique<Worker>(*this, w));
+
+        // The workers render parts of the audio thread's block, so they are scheduled like it; without the rights
+        //  to do so, they still work at the normal priority
+        if (!workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions().withPriority(10))) {
+            workers.back()->startThread(juce::Thread::Priority::highest);
+        }
+    }
+
+    // From now on, run() may hand tasks to the workers
+    startedWorkersCount.store(workersLimit, std::memory_order_release);
+}
+
+void RealtimeWorkerPool::setSpinTime(double seconds)
+{
+    const auto ticks = static_cast<int64_t>(seconds * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()));
+    int64_t current = spinTicks.load();
+
+    while (ticks > current && !spinTicks.compare_exchange_weak(current, ticks)) {}
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    stopping = true;
+    ++wakeups;
+    wakeAll(wakeups);
+
+    for (auto& worker : workers) {
+        worker->stopThread(-1);
+    }
+}
+
+void RealtimeWorkerPool::run(int tasksCount, int helpersCount, void (*task_)(void* context, int taskIndex), void* context)
+{
+    if (tasksCount <= 0) { return; }
+
+    helpersCount = std::min({ helpersCount, getWorkersCount(), tasksCount - 1 });
+
+    // Without helpers, or while the workers are busy with another thread's tasks, this thread does them all
+    if (helpersCount <= 0 || busy.exchange(true, std::memory_order_acquire)) {
+        for (int i = 0; i < tasksCount; ++i) {
+            task_(context, i);
+        }
+        return;
+    }
+
+    // The previous run is done, so no worker reads the task while it changes; storing claims publishes it
+    task = task_;
+    taskContext = context;
+    pendingTasks.store(tasksCount, std::memory_order_relaxed);
+    claims.store((static_cast<uint64_t>(helpersCount) << 32) | static_cast<uint64_t>(tasksCount));
+
+    // A worker going to sleep counts itself before it reads wakeups, so either it sees this change, or it is
+    //  counted here; the system call is only made when a worker has gone to sleep
+    ++wakeups;
+
+    if (sleepingWorkers.load() > 0) {
+        wakeAll(wakeups);
+    }
+
+    // The calling thread works too, then waits for the tasks taken by the workers, which are already running
+    while (runNextTask(-1)) {}
+
+    while (pendingTasks.load(std::memory_order_acquire) > 0) {
+        spinPause();
+    }
+
+    busy.store(false, std::memory_order_release);
+}
+
+bool RealtimeWorkerPool::runNextTask(int workerIndex)
+{
+    uint64_t current = claims.load(std::memory_order_acquire);
+
+    for (;;) {
+        const int helpersCount = static_cast<int>(current >> 32);
+        const uint32_t tasksLeft = static_cast<uint32_t>(current);
+
+        if (tasksLeft == 0 || workerIndex >= helpersCount) {
+            return false;
+        }
+
+        // LRN compare_exchange_weak reloads current when another thread changed claims first, and may fail
+        //  spuriously, so it is called in a loop
+        if (claims.compare_exchange_weak(current, current - 1, std::memory_order_acquire)) {
+            // The task is read once claimed: it can be from a newer run than the claims seen before, but it can't
+            //  change before this task is done
+            task(taskContext, static_cast<int>(tasksLeft - 1));
+            pendingTasks.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+void RealtimeWorkerPool::work(int workerIndex)
+{
+    // Time when the worker ran out of tasks, or 0 while it has some
+    int64_t idleSince = 0;
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (runNextTask(workerIndex)) {
+            idleSince = 0;
+            continue;
+        }
+
+        // A pause is a few dozen cycles on some processors and over a hundred on others, so the spin is timed
+        const int64_t now = juce::Time::getHighResolutionTicks();
+
+        if (idleSince == 0) {
+            idleSince = now;
+        }
+
+        if (now - idleSince < spinTicks.load(std::memory_order_relaxed)) {
+            spinPause();
+            continue;
+        }
+
+        // Nothing came for a while: sleep until the next run, unless it was published in the meantime
+        ++sleepingWorkers;
+        const uint32_t seenWakeups = wakeups.load();
+        const uint64_t current = claims.load();
+        const bool hasTask = static_cast<uint32_t>(current) > 0 && workerIndex < static_cast<int>(current >> 32);
+
+        if (!hasTask && !stopping.load()) {
+            waitWhileEqual(wakeups, seenWakeups);
+        }
+
+        --sleepingWorkers;
+        idleSince = 0;
+    }
+}
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerPool.h
+    Created: 17 Oct 2026 9:42:18am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Constants.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ This class spreads the tasks of a render over worker threads, so the voices of a synth can use several cores.
+ Unlike ParallelPreparation, it is meant for the audio thread: the workers run at real-time priority, and run() never
+ allocates nor locks. They are only started by startWorkers(), once a synth asks for more than one render thread, so
+ a process that never does has none. The tasks are handed over through atomics; after its last task, a worker spins
+ for about a block period (see setSpinTime()), so the next block finds it awake, then sleeps on a futex until run()
+ wakes it.
+ Several threads (the audio threads of several synth instances) may share a pool: the one calling run() while it
+ works for another does all its tasks itself.
+ */
+class RealtimeWorkerPool
+{
+public:
+    /**
+     Allows a worker for every physical core but the caller's, up to constants::MAX_RENDER_THREADS threads with it;
+     this is the pool shared through juce::SharedResourcePointer.
+     */
+    RealtimeWorkerPool();
+
+    /**
+     Allows workersCount worker threads; with none, run() does every task on the calling thread.
+     */
+    explicit RealtimeWorkerPool(int workersCount);
+
+    /**
+     Stops the workers. No run() may be in progress.
+     */
+    ~RealtimeWorkerPool();
+
+    /**
+     Starts the workers, unless they are already. Not to be called on the audio thread.
+     */
+    void startWorkers();
+
+    /**
+     Makes an idle worker spin for at least this time before it sleeps; several synths may ask, and the longest time
+     is kept. Called with the block period of a synth, so the workers stay awake from one block to the next.
+     */
+    void setSpinTime(double seconds);
+
+    /**
+     Workers started, 0 until startWorkers() is called.
+     */
+    int getWorkersCount() const { return startedWorkersCount.load(std::memory_order_acquire); }
+
+    /**
+     Calls task(i) for every i in [0, tasksCount), spread over the calling thread and at most helpersCount workers
+     (none while another thread's run() is in progress), and returns once they are all done. The tasks must not
+     depend on each other.
+     */
+    template <typename Task>
+    void run(int tasksCount, int helpersCount, Task& task)
+    {
+        run(tasksCount, helpersCount, [](void* context, int i) { (*static_cast<Task*>(context))(i); }, &task);
+    }
+
+    /**
+     Same as above, with task(context, i) called for every task.
+     */
+    void run(int tasksCount, int helpersCount, void (*task)(void* context, int taskIndex), void* context);
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(RealtimeWorkerPool& pool, int index);
+        void run() override;
+
+    private:
+        RealtimeWorkerPool& pool;
+        const int index;
+    };
+
+    const int workersLimit;
+    std::vector<std::unique_ptr<Worker>> workers;
+    juce::CriticalSection startLock; // held while the workers are started
+    std::atomic<int> startedWorkersCount { 0 }; // published once every worker runs
+    std::atomic<int64_t> spinTicks { 0 }; // high-resolution ticks an idle worker spins before it sleeps
+
+    // The task of the current run, written by run() before it publishes the run in claims
+    void (*task)(void* context, int taskIndex) = nullptr;
+    void* taskContext = nullptr;
+
+    // LRN std::atomic of 64 bits is lock-free on every 64-bit processor, so one compare-exchange updates both halves
+    // Helpers allowed in the current run (high 32 bits) and tasks left to claim (low 32 bits); the tasks are claimed
+    //  from the last one
+    std::atomic<uint64_t> claims { 0 };
+    std::atomic<int> pendingTasks { 0 }; // tasks of the current run that are not done
+    std::atomic<uint32_t> wakeups { 0 }; // futex the sleeping workers wait on, changed by every run
+    std::atomic<int> sleepingWorkers { 0 };
+    std::atomic<bool> stopping { false };
+    std::atomic<bool> busy { false }; // a run() has the workers
+
+    /**
+     Claims a task of the current run for a worker (-1 for the calling thread) and does it. Returns false when
+     there is none left for it.
+     */
+    bool runNextTask(int workerIndex);
+
+    /**
+     Runs a worker's tasks until the pool stops.
+     */
+    void work(int workerIndex);
+};
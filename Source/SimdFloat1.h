@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    SimdFloat1.h
+    Created: 13 Oct 2026 10:31:18am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+#include "WavetableFormats.h"
+
+namespace simd
+{
+    /**
+     A single float with the interface of the SIMD wrappers, so the kernels also build (one lane at a time) for
+     processors without SSE2, and serve as the reference the vectorized kernels are measured against.
+     */
+    struct float1
+    {
+        static constexpr int width { 1 };
+
+        float value;
+
+        struct Mask
+        {
+            bool value;
+        };
+
+        struct UInt
+        {
+            uint32_t value;
+
+            static UInt load(const uint32_t* source) { return { *source }; }
+            void store(uint32_t* destination) const { *destination = value; }
+            static UInt broadcast(uint32_t x) { return { x }; }
+
+            friend UInt operator+(UInt a, UInt b) { return { a.value + b.value }; }
+            friend UInt operator&(UInt a, UInt b) { return { a.value & b.value }; }
+
+            template <int bits>
+            UInt shiftRight() const { return { value >> bits }; }
+
+            template <int bits>
+            UInt shiftLeft() const { return { value << bits }; }
+
+            float1 toFloat() const { return { static_cast<float>(value) }; }
+        };
+
+        static float1 load(const float* source) { return { *source }; }
+        void store(float* destination) const { *destination = value; }
+        static float1 broadcast(float x) { return { x }; }
+
+        // Rounds to the nearest integer, in two's complement (values must fit in 32-bit signed integers)
+        UInt roundToInt() const { return { static_cast<uint32_t>(static_cast<int32_t>(std::lrint(value))) }; }
+
+        friend float1 operator+(float1 a, float1 b) { return { a.value + b.value }; }
+        friend float1 operator-(float1 a, float1 b) { return { a.value - b.value }; }
+        friend float1 operator*(float1 a, float1 b) { return { a.value * b.value }; }
+
+        static Mask greaterThan(float1 a, float1 b) { return { a.value > b.value }; }
+        static bool any(Mask mask) { return mask.value; }
+        static float1 select(Mask mask, float1 a, float1 b) { return mask.value ? a : b; }
+
+        static void fetchPairs(const WavetableSample* const* tables, const uint32_t* indexes, float1& current, float1& next)
+        {
+            current.value = WavetableFormat::decode(tables[0][indexes[0]]);
+            next.value = WavetableFormat::decode(tables[0][indexes[0] + 1]);
+        }
+
+        static void transposeToLanes(const float* block, float* const* outputs, int numSamples)
+        {
+            std::copy(block, block + numSamples, outputs[0]);
+        }
+
+        static void transposeFromLanes(const float* const* inputs, float* block, int numSamples)
+        {
+            std::copy(inputs[0], inputs[0] + numSamples, block);
+        }
+    };
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    SimdFloat16.h
+    Created: 13 Oct 2026 10:14:52am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SimdFloat4.h"
+
+namespace simd
+{
+    /**
+     16 floats (32-bit, not half floats) in an AVX-512 register. Only include this where the code is compiled for
+     AVX-512F (see SimdKernelsAVX512.cpp).
+     */
+    struct float16
+    {
+        static constexpr int width { 16 };
+
+        __m512 value;
+
+        /**
+         Result of a comparison, one bit per lane (AVX-512 has dedicated mask registers).
+         */
+        struct Mask
+        {
+            __mmask16 value;
+        };
+
+        /**
+         16 unsigned 32-bit integers, for fixed-point phases.
+         */
+        struct UInt
+        {
+            __m512i value;
+
+            static CPPSYNTH_SIMD_INLINE UInt load(const uint32_t* source) { return { _mm512_loadu_si512(source) }; }
+            CPPSYNTH_SIMD_INLINE void store(uint32_t* destination) const { _mm512_storeu_si512(destination, value); }
+            static CPPSYNTH_SIMD_INLINE UInt broadcast(uint32_t x) { return { _mm512_set1_epi32(static_cast<int>(x)) }; }
+
+            friend CPPSYNTH_SIMD_INLINE UInt operator+(UInt a, UInt b) { return { _mm512_add_epi32(a.value, b.value) }; }
+            friend CPPSYNTH_SIMD_INLINE UInt operator&(UInt a, UInt b) { return { _mm512_and_si512(a.value, b.value) }; }
+
+            template <int bits>
+            CPPSYNTH_SIMD_INLINE UInt shiftRight() const { return { _mm512_srli_epi32(value, bits) }; }
+
+            template <int bits>
+            CPPSYNTH_SIMD_INLINE UInt shiftLeft() const { return { _mm512_slli_epi32(value, bits) }; }
+
+            // Values must be under 2^31 (the conversion is signed)
+            CPPSYNTH_SIMD_INLINE float16 toFloat() const { return { _mm512_cvtepi32_ps(value) }; }
+        };
+
+        static CPPSYNTH_SIMD_INLINE float16 load(const float* source) { return { _mm512_loadu_ps(source) }; }
+        CPPSYNTH_SIMD_INLINE void store(float* destination) const { _mm512_storeu_ps(destination, value); }
+        static CPPSYNTH_SIMD_INLINE float16 broadcast(float x) { return { _mm512_set1_ps(x) }; }
+
+        // Rounds to the nearest integer, in two's complement (values must fit in 32-bit signed integers)
+        CPPSYNTH_SIMD_INLINE UInt roundToInt() const { return { _mm512_cvtps_epi32(value) }; }
+
+        friend CPPSYNTH_SIMD_INLINE float16 operator+(float16 a, float16 b) { return { _mm512_add_ps(a.value, b.value) }; }
+        friend CPPSYNTH_SIMD_INLINE float16 operator-(float16 a, float16 b) { return { _mm512_sub_ps(a.value, b.value) }; }
+        friend CPPSYNTH_SIMD_INLINE float16 operator*(float16 a, float16 b) { return { _mm512_mul_ps(a.value, b.value) }; }
+
+        static CPPSYNTH_SIMD_INLINE Mask greaterThan(float16 a, float16 b) { return { _mm512_cmp_ps_mask(a.value, b.value, _CMP_GT_OQ) }; }
+        static CPPSYNTH_SIMD_INLINE bool any(Mask mask) { return mask.value != 0; }
+
+        // Lanes of a where mask is true, lanes of b elsewhere
+        static CPPSYNTH_SIMD_INLINE float16 select(Mask mask, float16 a, float16 b) { return { _mm512_mask_blend_ps(mask.value, b.value, a.value) }; }
+
+        /**
+         Loads the two samples every lane interpolates between (at index and index + 1 in the lane's table), and
+         returns the first samples of the lanes in current and the second ones in next.
+         */
+        static CPPSYNTH_SIMD_INLINE void fetchPairs(const WavetableSample* const* tables, const uint32_t* indexes,
+                                                    float16& current, float16& next)
+        {
+            // Same as float8: each lane gathers a whole pair from its table pointer plus the offset of its index
+            static_assert(sizeof(const WavetableSample*) == sizeof(int64_t), "table pointers must be 64-bit");
+            constexpr int sampleShift { sizeof(WavetableSample) == 4 ? 2 : 1 };
+
+            const __m512i lowOffsets = _mm512_slli_epi64(_mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes))), sampleShift);
+            const __m512i highOffsets = _mm512_slli_epi64(_mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + 8))), sampleShift);
+            const __m512i lowAddresses = _mm512_add_epi64(_mm512_loadu_si512(tables), lowOffsets);
+            const __m512i highAddresses = _mm512_add_epi64(_mm512_loadu_si512(tables + 8), highOffsets);
+
+            if constexpr (std::is_same_v<WavetableFormat, wavetableFormats::Float32>) {
+                // [c0 n0 ... c7 n7] and [c8 n8 ... c15 n15]
+                const __m512 low = _mm512_castpd_ps(_mm512_i64gather_pd(lowAddresses, nullptr, 1));
+                const __m512 high = _mm512_castpd_ps(_mm512_i64gather_pd(highAddresses, nullptr, 1));
+
+                // Even (then odd) floats of both vectors; bit 4 of an index picks the second vector
+                const __m512i currentIndexes = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+                const __m512i nextIndexes = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+                current.value = _mm512_permutex2var_ps(low, currentIndexes, high);
+                next.value = _mm512_permutex2var_ps(low, nextIndexes, high);
+            }
+            else {
+                // One 32-bit pair per lane: the first sample in the low half, the second in the high half
+                const __m512i pairs = _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_i64gather_epi32(lowAddresses, nullptr, 1)),
+                                                         _mm512_i64gather_epi32(highAddresses, nullptr, 1), 1);
+
+                if constexpr (std::is_same_v<WavetableFormat, wavetableFormats::Int16>) {
+                    const __m512 scale = _mm512_set1_ps(wavetableFormats::Int16::toFloat);
+                    current.value = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srai_epi32(_mm512_slli_epi32(pairs, 16), 16)), scale);
+                    next.value = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srai_epi32(pairs, 16)), scale);
+                }
+                else {
+                    // Narrowing every 32-bit pair to 16 bits keeps its low half, the first sample
+                    current.value = _mm512_cvtph_ps(_mm512_cvtepi32_epi16(pairs));
+                    next.value = _mm512_cvtph_ps(_mm512_cvtepi32_epi16(_mm512_srli_epi32(pairs, 16)));
+                }
+            }
+        }
+
+        static CPPSYNTH_SIMD_INLINE void transposeToLanes(const float* block, float* const* outputs, int numSamples)
+        {
+            float4::transposeToLanes(block, width, outputs, numSamples);
+        }
+
+        static CPPSYNTH_SIMD_INLINE void transposeFromLanes(const float* const* inputs, float* block, int numSamples)
+        {
+            float4::transposeFromLanes(inputs, block, width, numSamples);
+        }
+    };
+}
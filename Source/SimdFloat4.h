@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    SimdFloat4.h
+    Created: 13 Oct 2026 9:21:37am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <immintrin.h>
+#include <cstring>
+#include <type_traits>
+#include "WavetableFormats.h"
+
+/**
+ Functions of the SIMD wrappers are always inlined: the same wrapper is compiled for several instruction sets (the
+ AVX kernels use float4 too), and an out-of-line copy compiled for one of them could be picked by the linker for
+ all the others.
+ */
+#if defined(_MSC_VER) && !defined(__clang__)
+ #define CPPSYNTH_SIMD_INLINE __forceinline
+#else
+ #define CPPSYNTH_SIMD_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace simd
+{
+    /**
+     4 floats in an SSE2 register. SSE2 is part of every x86-64 processor, so this is the baseline of the kernels.
+     */
+    struct float4
+    {
+        static constexpr int width { 4 };
+
+        __m128 value;
+
+        /**
+         Result of a comparison, true or false for every lane.
+         */
+        struct Mask
+        {
+            __m128 value;
+        };
+
+        /**
+         4 unsigned 32-bit integers, for fixed-point phases.
+         */
+        struct UInt
+        {
+            __m128i value;
+
+            static CPPSYNTH_SIMD_INLINE UInt load(const uint32_t* source) { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)) }; }
+            CPPSYNTH_SIMD_INLINE void store(uint32_t* destination) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), value); }
+            static CPPSYNTH_SIMD_INLINE UInt broadcast(uint32_t x) { return { _mm_set1_epi32(static_cast<int>(x)) }; }
+
+            friend CPPSYNTH_SIMD_INLINE UInt operator+(UInt a, UInt b) { return { _mm_add_epi32(a.value, b.value) }; }
+            friend CPPSYNTH_SIMD_INLINE UInt operator&(UInt a, UInt b) { return { _mm_and_si128(a.value, b.value) }; }
+
+            template <int bits>
+            CPPSYNTH_SIMD_INLINE UInt shiftRight() const { return { _mm_srli_epi32(value, bits) }; }
+
+            template <int bits>
+            CPPSYNTH_SIMD_INLINE UInt shiftLeft() const { return { _mm_slli_epi32(value, bits) }; }
+
+            // Values must be under 2^31 (the conversion is signed)
+            CPPSYNTH_SIMD_INLINE float4 toFloat() const { return { _mm_cvtepi32_ps(value) }; }
+        };
+
+        static CPPSYNTH_SIMD_INLINE float4 load(const float* source) { return { _mm_loadu_ps(source) }; }
+        CPPSYNTH_SIMD_INLINE void store(float* destination) const { _mm_storeu_ps(destination, value); }
+        static CPPSYNTH_SIMD_INLINE float4 broadcast(float x) { return { _mm_set1_ps(x) }; }
+
+        // Rounds to the nearest integer, in two's complement (values must fit in 32-bit signed integers)
+        CPPSYNTH_SIMD_INLINE UInt roundToInt() const { return { _mm_cvtps_epi32(value) }; }
+
+        friend CPPSYNTH_SIMD_INLINE float4 operator+(float4 a, float4 b) { return { _mm_add_ps(a.value, b.value) }; }
+        friend CPPSYNTH_SIMD_INLINE float4 operator-(float4 a, float4 b) { return { _mm_sub_ps(a.value, b.value) }; }
+        friend CPPSYNTH_SIMD_INLINE float4 operator*(float4 a, float4 b) { return { _mm_mul_ps(a.value, b.value) }; }
+
+        static CPPSYNTH_SIMD_INLINE Mask greaterThan(float4 a, float4 b) { return { _mm_cmpgt_ps(a.value, b.value) }; }
+        static CPPSYNTH_SIMD_INLINE bool any(Mask mask) { return _mm_movemask_ps(mask.value) != 0; }
+
+        // Lanes of a where mask is true, lanes of b elsewhere
+        static CPPSYNTH_SIMD_INLINE float4 select(Mask mask, float4 a, float4 b)
+        {
+            return { _mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value)) };
+        }
+
+        /**
+         Loads the two samples every lane interpolates between (at index and index + 1 in the lane's table), and
+         returns the first samples of the lanes in current and the second ones in next.
+         */
+        static CPPSYNTH_SIMD_INLINE void fetchPairs(const WavetableSample* const* tables, const uint32_t* indexes,
+                                                    float4& current, float4& next)
+        {
+            // LRN every lane reads its own table, so there is no vector load for them; instead each lane loads both its
+            //  samples at once (they are next to each other), and the pairs are put back in order with shuffles
+            __m128i pairs[4];
+
+            for (int l = 0; l < 4; ++l) {
+                const WavetableSample* samples = tables[l] + indexes[l];
+
+                if constexpr (sizeof(WavetableSample) == 4) {
+                    pairs[l] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples));
+                }
+                else {
+                    int32_t pair;
+                    std::memcpy(&pair, samples, sizeof(pair));
+                    pairs[l] = _mm_cvtsi32_si128(pair);
+                }
+            }
+
+            if constexpr (std::is_same_v<WavetableFormat, wavetableFormats::Float32>) {
+                // [c0 n0 c1 n1] and [c2 n2 c3 n3]
+                const __m128 low = _mm_castsi128_ps(_mm_unpacklo_epi64(pairs[0], pairs[1]));
+                const __m128 high = _mm_castsi128_ps(_mm_unpacklo_epi64(pairs[2], pairs[3]));
+                current.value = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                next.value = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+            }
+            else {
+                // [c0 n0 c1 n1 c2 n2 c3 n3], as 16-bit values
+                const __m128i packed = _mm_unpacklo_epi64(_mm_unpacklo_epi32(pairs[0], pairs[1]),
+                                                          _mm_unpacklo_epi32(pairs[2], pairs[3]));
+
+                if constexpr (std::is_same_v<WavetableFormat, wavetableFormats::Int16>) {
+                    // The first sample of each pair is in the low half of a 32-bit value, the second in the high half
+                    const __m128 scale = _mm_set1_ps(wavetableFormats::Int16::toFloat);
+                    current.value = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 16), 16)), scale);
+                    next.value = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(packed, 16)), scale);
+                }
+                else {
+                   #if CPPSYNTH_WAVETABLE_FORMATS_F16C
+                    const __m128 low = _mm_cvtph_ps(packed);
+                    const __m128 high = _mm_cvtph_ps(_mm_unpackhi_epi64(packed, packed));
+                   #else
+                    alignas(16) uint16_t halves[8];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(halves), packed);
+                    const __m128 low = _mm_set_ps(WavetableFormat::decode(halves[3]), WavetableFormat::decode(halves[2]),
+                                                  WavetableFormat::decode(halves[1]), WavetableFormat::decode(halves[0]));
+                    const __m128 high = _mm_set_ps(WavetableFormat::decode(halves[7]), WavetableFormat::decode(halves[6]),
+                                                   WavetableFormat::decode(halves[5]), WavetableFormat::decode(halves[4]));
+                   #endif
+                    current.value = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                    next.value = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+                }
+            }
+        }
+
+        /**
+         Copies the samples of a block holding blockWidth lanes per sample (a multiple of 4) to the output of every lane.
+         */
+        static CPPSYNTH_SIMD_INLINE void transposeToLanes(const float* block, int blockWidth, float* const* outputs, int numSamples)
+        {
+            int i = 0;
+
+            // LRN 4 samples of 4 lanes form a 4x4 matrix; transposing it in registers gives 4 samples of each lane,
+            //  which are stored at once instead of one by one
+            for (; i + 4 <= numSamples; i += 4) {
+                for (int l = 0; l < blockWidth; l += 4) {
+                    __m128 row0 = _mm_loadu_ps(block + i * blockWidth + l);
+                    __m128 row1 = _mm_loadu_ps(block + (i + 1) * blockWidth + l);
+                    __m128 row2 = _mm_loadu_ps(block + (i + 2) * blockWidth + l);
+                    __m128 row3 = _mm_loadu_ps(block + (i + 3) * blockWidth + l);
+                    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+                    _mm_storeu_ps(outputs[l] + i, row0);
+                    _mm_storeu_ps(outputs[l + 1] + i, row1);
+                    _mm_storeu_ps(outputs[l + 2] + i, row2);
+                    _mm_storeu_ps(outputs[l + 3] + i, row3);
+                }
+            }
+
+            for (; i < numSamples; ++i) {
+                for (int l = 0; l < blockWidth; ++l) {
+                    outputs[l][i] = block[i * blockWidth + l];
+                }
+            }
+        }
+
+        /**
+         Copies the samples of every lane's input to a block holding blockWidth lanes per sample (a multiple of 4).
+         */
+        static CPPSYNTH_SIMD_INLINE void transposeFromLanes(const float* const* inputs, float* block, int blockWidth, int numSamples)
+        {
+            int i = 0;
+
+            for (; i + 4 <= numSamples; i += 4) {
+                for (int l = 0; l < blockWidth; l += 4) {
+                    __m128 row0 = _mm_loadu_ps(inputs[l] + i);
+                    __m128 row1 = _mm_loadu_ps(inputs[l + 1] + i);
+                    __m128 row2 = _mm_loadu_ps(inputs[l + 2] + i);
+                    __m128 row3 = _mm_loadu_ps(inputs[l + 3] + i);
+                    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+                    _mm_storeu_ps(block + i * blockWidth + l, row0);
+                    _mm_storeu_ps(block + (i + 1) * blockWidth + l, row1);
+                    _mm_storeu_ps(block + (i + 2) * blockWidth + l, row2);
+                    _mm_storeu_ps(block + (i + 3) * blockWidth + l, row3);
+                }
+            }
+
+            for (; i < numSamples; ++i) {
+                for (int l = 0; l < blockWidth; ++l) {
+                    block[i * blockWidth + l] = inputs[l][i];
+                }
+            }
+        }
+
+        static CPPSYNTH_SIMD_INLINE void transposeToLanes(const float* block, float* const* outputs, int numSamples)
+        {
+            transposeToLanes(block, width, outputs, numSamples);
+        }
+
+        static CPPSYNTH_SIMD_INLINE void transposeFromLanes(const float* const* inputs, float* block, int numSamples)
+        {
+            transposeFromLanes(inputs, block, width, numSamples);
+        }
+    };
+}
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    SimdFloat8.h
+    Created: 13 Oct 2026 9:48:05am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SimdFloat4.h"
+
+namespace simd
+{
+    /**
+     8 floats in an AVX register. Only include this where the code is compiled for AVX2, FMA and F16C
+     (see SimdKernelsAVX2.cpp); every processor with AVX2 also has the two others.
+     */
+    struct float8
+    {
+        static constexpr int width { 8 };
+
+        __m256 value;
+
+        /**
+         Result of a comparison, true or false for every lane.
+         */
+        struct Mask
+        {
+            __m256 value;
+        };
+
+        /**
+         8 unsigned 32-bit integers, for fixed-point phases.
+         */
+        struct UInt
+        {
+            __m256i value;
+
+            static CPPSYNTH_SIMD_INLINE UInt load(const uint32_t* source) { return { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source)) }; }
+            CPPSYNTH_SIMD_INLINE void store(uint32_t* destination) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), value); }
+            static CPPSYNTH_SIMD_INLINE UInt broadcast(uint32_t x) { return { _mm256_set1_epi32(static_cast<int>(x)) }; }
+
+            friend CPPSYNTH_SIMD_INLINE UInt operator+(UInt a, UInt b) { return { _mm256_add_epi32(a.value, b.value) }; }
+            friend CPPSYNTH_SIMD_INLINE UInt operator&(UInt a, UInt b) { return { _mm256_and_si256(a.value, b.value) }; }
+
+            template <int bits>
+            CPPSYNTH_SIMD_INLINE UInt shiftRight() const { return { _mm256_srli_epi32(value, bits) }; }
+
+            template <int bits>
+            CPPSYNTH_SIMD_INLINE UInt shiftLeft() const { return { _mm256_slli_epi32(value, bits) }; }
+
+            // Values must be under 2^31 (the conversion is signed)
+            CPPSYNTH_SIMD_INLINE float8 toFloat() const { return { _mm256_cvtepi32_ps(value) }; }
+        };
+
+        static CPPSYNTH_SIMD_INLINE float8 load(const float* source) { return { _mm256_loadu_ps(source) }; }
+        CPPSYNTH_SIMD_INLINE void store(float* destination) const { _mm256_storeu_ps(destination, value); }
+        static CPPSYNTH_SIMD_INLINE float8 broadcast(float x) { return { _mm256_set1_ps(x) }; }
+
+        // Rounds to the nearest integer, in two's complement (values must fit in 32-bit signed integers)
+        CPPSYNTH_SIMD_INLINE UInt roundToInt() const { return { _mm256_cvtps_epi32(value) }; }
+
+        friend CPPSYNTH_SIMD_INLINE float8 operator+(float8 a, float8 b) { return { _mm256_add_ps(a.value, b.value) }; }
+        friend CPPSYNTH_SIMD_INLINE float8 operator-(float8 a, float8 b) { return { _mm256_sub_ps(a.value, b.value) }; }
+        friend CPPSYNTH_SIMD_INLINE float8 operator*(float8 a, float8 b) { return { _mm256_mul_ps(a.value, b.value) }; }
+
+        static CPPSYNTH_SIMD_INLINE Mask greaterThan(float8 a, float8 b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ) }; }
+        static CPPSYNTH_SIMD_INLINE bool any(Mask mask) { return _mm256_movemask_ps(mask.value) != 0; }
+
+        // Lanes of a where mask is true, lanes of b elsewhere
+        static CPPSYNTH_SIMD_INLINE float8 select(Mask mask, float8 a, float8 b) { return { _mm256_blendv_ps(b.value, a.value, mask.value) }; }
+
+        /**
+         Loads the two samples every lane interpolates between (at index and index + 1 in the lane's table), and
+         returns the first samples of the lanes in current and the second ones in next.
+         */
+        static CPPSYNTH_SIMD_INLINE void fetchPairs(const WavetableSample* const* tables, const uint32_t* indexes,
+                                                    float8& current, float8& next)
+        {
+            // LRN AVX2 gathers 4 values from any 4 addresses at once. The addresses are the table pointers plus the
+            //  byte offsets of the indexes, so the gather base is null; each value is a whole pair of samples
+            static_assert(sizeof(const WavetableSample*) == sizeof(int64_t), "table pointers must be 64-bit");
+            constexpr int sampleShift { sizeof(WavetableSample) == 4 ? 2 : 1 };
+
+            const __m256i lowOffsets = _mm256_slli_epi64(_mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indexes))), sampleShift);
+            const __m256i highOffsets = _mm256_slli_epi64(_mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indexes + 4))), sampleShift);
+            const __m256i lowAddresses = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables)), lowOffsets);
+            const __m256i highAddresses = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables + 4)), highOffsets);
+
+            if constexpr (std::is_same_v<WavetableFormat, wavetableFormats::Float32>) {
+                const __m256 low = _mm256_castpd_ps(_mm256_i64gather_pd(nullptr, lowAddresses, 1));
+                const __m256 high = _mm256_castpd_ps(_mm256_i64gather_pd(nullptr, highAddresses, 1));
+
+                // [c0 n0 c1 n1 | c2 n2 c3 n3] and [c4 n4 c5 n5 | c6 n6 c7 n7]
+                const __m256 permutedLow = _mm256_permute2f128_ps(low, high, 0x20);
+                const __m256 permutedHigh = _mm256_permute2f128_ps(low, high, 0x31);
+                current.value = _mm256_shuffle_ps(permutedLow, permutedHigh, _MM_SHUFFLE(2, 0, 2, 0));
+                next.value = _mm256_shuffle_ps(permutedLow, permutedHigh, _MM_SHUFFLE(3, 1, 3, 1));
+            }
+            else {
+                // One 32-bit pair per lane: the first sample in the low half, the second in the high half
+                const __m256i pairs = _mm256_set_m128i(_mm256_i64gather_epi32(nullptr, highAddresses, 1),
+                                                       _mm256_i64gather_epi32(nullptr, lowAddresses, 1));
+
+                if constexpr (std::is_same_v<WavetableFormat, wavetableFormats::Int16>) {
+                    const __m256 scale = _mm256_set1_ps(wavetableFormats::Int16::toFloat);
+                    current.value = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(pairs, 16), 16)), scale);
+                    next.value = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(pairs, 16)), scale);
+                }
+                else {
+                    // Gather the first (then the second) halves of every pair in the low 64 bits of each 128-bit
+                    //  half, and join these to get the 8 half floats to convert
+                    const __m256i currentBytes = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                                  0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+                    const __m256i nextBytes = _mm256_setr_epi8(2, 3, 6, 7, 10, 11, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                               2, 3, 6, 7, 10, 11, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+                    const __m256i currentHalves = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pairs, currentBytes), _MM_SHUFFLE(3, 1, 2, 0));
+                    const __m256i nextHalves = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pairs, nextBytes), _MM_SHUFFLE(3, 1, 2, 0));
+
+                    current.value = _mm256_cvtph_ps(_mm256_castsi256_si128(currentHalves));
+                    next.value = _mm256_cvtph_ps(_mm256_castsi256_si128(nextHalves));
+                }
+            }
+        }
+
+        static CPPSYNTH_SIMD_INLINE void transposeToLanes(const float* block, float* const* outputs, int numSamples)
+        {
+            float4::transposeToLanes(block, width, outputs, numSamples);
+        }
+
+        static CPPSYNTH_SIMD_INLINE void transposeFromLanes(const float* const* inputs, float* block, int numSamples)
+        {
+            float4::transposeFromLanes(inputs, block, width, numSamples);
+        }
+    };
+}
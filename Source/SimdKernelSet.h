@@ -0,0 +1,617 @@
+/*
+  ==============================================================================
+
+    SimdKernelSet.h
+    Created: 13 Oct 2026 11:26:09am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SimdKernels.h"
+#include "InterpolationPolicies.h"
+
+/**
+ The kernels of SimdKernels, written once for any SIMD wrapper (simd::float1, float4, float8 or float16).
+ Only include this in the file of an instruction set, after its wrapper, where the code is compiled for that
+ instruction set. Everything here depends on Vector, so the sets never share code compiled for another instruction
+ set; for the same reason, nothing from the standard library is used in the kernels.
+
+ The kernels do the same operations in the same order as the classes they replace (WavetableOscillator::renderBlock,
+ Envelope::nextValue, StateVariableFilter::render and the voice's mix), so they only differ from them where the
+ compiler fuses a multiply and an add.
+ */
+template <typename Vector>
+class SimdKernelSet
+{
+public:
+    static SimdKernels create(SimdKernels::Level level, const char* name)
+    {
+        return { level, name, width, &renderOscillators, &renderModulatedOscillators, &renderPartials, &renderEnvelopes,
+                 &renderFilters, &mixOscillators, &addMultiplied, &decimate };
+    }
+
+    static void renderOscillators(WavetableOscillator::Lane* lanes, int numLanes, int numSamples, interpolation::Mode mode)
+    {
+        renderOscillatorsWithMode<false>(lanes, numLanes, numSamples, mode);
+    }
+
+    static void renderModulatedOscillators(WavetableOscillator::Lane* lanes, int numLanes, int numSamples, interpolation::Mode mode)
+    {
+        renderOscillatorsWithMode<true>(lanes, numLanes, numSamples, mode);
+    }
+
+    static void renderPartials(const AdditiveOscillator::Partials& partials, float* output, int numSamples)
+    {
+        jassert(numSamples <= maxSamples);
+        jassert(partials.count % width == 0);
+
+        // Every lane adds up its own partials for every sample; the lanes are added together at the end
+        alignas(64) float block[maxSamples * width];
+        const Vector zero = Vector::broadcast(0.0f);
+
+        for (int i = 0; i < numSamples; ++i) {
+            zero.store(block + i * width);
+        }
+
+        // Four vectors of partials at a time, so the rotations of one sample don't wait for each other
+        constexpr int vectors { 4 };
+        int first = 0;
+
+        for (; first + vectors * width <= partials.count; first += vectors * width) {
+            Vector sines[vectors], cosines[vectors], rotationSines[vectors], rotationCosines[vectors], amplitudes[vectors];
+
+            for (int v = 0; v < vectors; ++v) {
+                const int p = first + v * width;
+                sines[v] = Vector::load(partials.sines.data() + p);
+                cosines[v] = Vector::load(partials.cosines.data() + p);
+                rotationSines[v] = Vector::load(partials.rotationSines.data() + p);
+                rotationCosines[v] = Vector::load(partials.rotationCosines.data() + p);
+                amplitudes[v] = Vector::load(partials.amplitudes.data() + p);
+            }
+
+            for (int i = 0; i < numSamples; ++i) {
+                Vector sum = Vector::load(block + i * width);
+
+                for (int v = 0; v < vectors; ++v) {
+                    sum = sum + amplitudes[v] * sines[v];
+
+                    const Vector nextSine = sines[v] * rotationCosines[v] + cosines[v] * rotationSines[v];
+                    cosines[v] = cosines[v] * rotationCosines[v] - sines[v] * rotationSines[v];
+                    sines[v] = nextSine;
+                }
+
+                sum.store(block + i * width);
+            }
+        }
+
+        for (; first < partials.count; first += width) {
+            Vector sine = Vector::load(partials.sines.data() + first);
+            Vector cosine = Vector::load(partials.cosines.data() + first);
+            const Vector rotationSine = Vector::load(partials.rotationSines.data() + first);
+            const Vector rotationCosine = Vector::load(partials.rotationCosines.data() + first);
+            const Vector amplitude = Vector::load(partials.amplitudes.data() + first);
+
+            for (int i = 0; i < numSamples; ++i) {
+                (Vector::load(block + i * width) + amplitude * sine).store(block + i * width);
+
+                const Vector nextSine = sine * rotationCosine + cosine * rotationSine;
+                cosine = cosine * rotationCosine - sine * rotationSine;
+                sine = nextSine;
+            }
+        }
+
+        // The sums of the lanes are turned into one row of samples per lane, and the rows are added
+        alignas(64) float rows[width][maxSamples];
+        float* rowPointers[width];
+
+        for (int l = 0; l < width; ++l) {
+            rowPointers[l] = rows[l];
+        }
+
+        Vector::transposeToLanes(block, rowPointers, numSamples);
+        int i = 0;
+
+        for (; i + width <= numSamples; i += width) {
+            Vector sum = Vector::load(rows[0] + i);
+
+            for (int l = 1; l < width; ++l) {
+                sum = sum + Vector::load(rows[l] + i);
+            }
+
+            sum.store(output + i);
+        }
+
+        for (; i < numSamples; ++i) {
+            float sum = rows[0][i];
+
+            for (int l = 1; l < width; ++l) {
+                sum += rows[l][i];
+            }
+
+            output[i] = sum;
+        }
+    }
+
+    static void renderEnvelopes(Envelope::States& states, int firstSlot, int endSlot, float* outputs, int outputsStride,
+                                int numSamples)
+    {
+        jassert(numSamples <= maxSamples);
+        jassert(firstSlot % width == 0);
+        static_assert(constants::VOICE_SLOTS % width == 0, "The slots must fill whole vectors");
+
+        alignas(64) float block[maxSamples * width];
+        float paddingOutput[maxSamples];
+
+        for (int first = firstSlot; first < endSlot; first += width) {
+            // The state of consecutive slots is loaded as is; the slots past endSlot are rendered for nothing
+            Vector level = Vector::load(states.level.data() + first);
+            Vector multiplier = Vector::load(states.multiplier.data() + first);
+            Vector target = Vector::load(states.target.data() + first);
+            const Vector decayMultiplier = Vector::load(states.decayMultiplier.data() + first);
+            const Vector sustainLevel = Vector::load(states.sustainLevel.data() + first);
+            const Vector silence = Vector::broadcast(constants::SILENCE_TRESHOLD);
+            const Vector decayThreshold = Vector::broadcast(constants::ENV_SUS_TARGET + constants::ENV_ATK_TARGET);
+            const Vector one = Vector::broadcast(1.0f);
+            const Vector zero = Vector::broadcast(0.0f);
+            Vector samplesCount = zero;
+
+            // Inactive lanes keep their state; the group stops when they are all inactive
+            typename Vector::Mask active = Vector::greaterThan(level, silence);
+            int renderedSamples = 0;
+
+            for (; renderedSamples < numSamples && Vector::any(active); ++renderedSamples) {
+                const Vector nextLevel = multiplier * (level - target) + target;
+
+                // Switch to the decay stage at the end of the attack stage
+                const typename Vector::Mask decays = Vector::greaterThan(nextLevel + target, decayThreshold);
+
+                level = Vector::select(active, nextLevel, level);
+                multiplier = Vector::select(active, Vector::select(decays, decayMultiplier, multiplier), multiplier);
+                target = Vector::select(active, Vector::select(decays, sustainLevel, target), target);
+                samplesCount = samplesCount + Vector::select(active, one, zero);
+
+                level.store(block + renderedSamples * width);
+                active = Vector::greaterThan(level, silence);
+            }
+
+            level.store(states.level.data() + first);
+            multiplier.store(states.multiplier.data() + first);
+            target.store(states.target.data() + first);
+
+            alignas(64) float activeSamples[width];
+            float* laneOutputs[width];
+            samplesCount.store(activeSamples);
+
+            for (int l = 0; l < width; ++l) {
+                states.activeSamples[first + l] = static_cast<int>(activeSamples[l]);
+                laneOutputs[l] = first + l < endSlot ? outputs + (first + l) * outputsStride : paddingOutput;
+            }
+
+            Vector::transposeToLanes(block, laneOutputs, renderedSamples);
+        }
+    }
+
+    static void renderFilters(StateVariableFilter::States& states, int firstSlot, int endSlot)
+    {
+        static_assert(StateVariableFilter::slotsCount % width == 0, "The slots must fill whole vectors");
+        jassert(firstSlot % width == 0);
+
+        alignas(64) float block[maxSamples * width];
+        const float paddingInput[maxSamples] {};
+        float paddingOutput[maxSamples];
+
+        for (int first = firstSlot; first < endSlot; first += width) {
+            alignas(64) float lengths[width];
+            const float* inputs[width];
+            float* outputs[width];
+            int numSamples = 0;
+
+            // Only the slots prepared for this block render; the others filter silence in paddingOutput
+            for (int l = 0; l < width; ++l) {
+                const int slot = first + l;
+                const int length = slot < endSlot ? states.numSamples[slot] : 0;
+                const bool prepared = length > 0;
+                lengths[l] = static_cast<float>(length);
+                inputs[l] = prepared ? states.inputs[slot] : paddingInput;
+                outputs[l] = prepared ? states.outputs[slot] : paddingOutput;
+                numSamples = length > numSamples ? length : numSamples;
+            }
+
+            if (numSamples == 0) {
+                continue;
+            }
+
+            jassert(numSamples <= maxSamples);
+            Vector::transposeFromLanes(inputs, block, numSamples);
+
+            const Vector a1 = Vector::load(states.a1.data() + first);
+            const Vector a2 = Vector::load(states.a2.data() + first);
+            const Vector a3 = Vector::load(states.a3.data() + first);
+            const Vector m0 = Vector::load(states.m0.data() + first);
+            const Vector m1 = Vector::load(states.m1.data() + first);
+            const Vector m2 = Vector::load(states.m2.data() + first);
+            const Vector length = Vector::load(lengths);
+            const Vector two = Vector::broadcast(2.0f);
+            Vector ic1eq = Vector::load(states.ic1eq.data() + first);
+            Vector ic2eq = Vector::load(states.ic2eq.data() + first);
+
+            for (int i = 0; i < numSamples; ++i) {
+                // Shorter lanes keep their state after their last sample
+                const typename Vector::Mask running = Vector::greaterThan(length, Vector::broadcast(static_cast<float>(i)));
+                const Vector v0 = Vector::load(block + i * width);
+
+                // voltages at nodes
+                const Vector v3 = v0 - ic2eq;
+                const Vector v1 = a1 * ic1eq + a2 * v3; // voltage for band-pass output
+                const Vector v2 = ic2eq + a2 * ic1eq + a3 * v3; // voltage for low-pass output
+
+                ic1eq = Vector::select(running, two * v1 - ic1eq, ic1eq);
+                ic2eq = Vector::select(running, two * v2 - ic2eq, ic2eq);
+
+                (m0 * v0 + m1 * v1 + m2 * v2).store(block + i * width);
+            }
+
+            ic1eq.store(states.ic1eq.data() + first);
+            ic2eq.store(states.ic2eq.data() + first);
+            Vector::transposeToLanes(block, outputs, numSamples);
+
+            for (int l = 0; l < width && first + l < endSlot; ++l) {
+                states.numSamples[first + l] = 0;
+            }
+        }
+    }
+
+    static void mixOscillators(const SimdKernels::OscillatorMix& mix, float* output, float* rightOutput, int numSamples)
+    {
+        // Index of every lane in a vector, to find the samples after the oscillators stop
+        alignas(64) float laneIndexes[width];
+
+        for (int l = 0; l < width; ++l) {
+            laneIndexes[l] = static_cast<float>(l);
+        }
+
+        constexpr int stride { SimdKernels::oscOutputsStride };
+        const bool stereo = mix.rightGains != nullptr;
+        const Vector laneIndex = Vector::load(laneIndexes);
+        const Vector osc1Gain = Vector::broadcast(mix.osc1Gain);
+        const Vector osc1Level = Vector::broadcast(mix.osc1Level);
+        const Vector osc1LevelStep = Vector::broadcast(mix.osc1LevelStep);
+        const Vector osc2Gain = Vector::broadcast(0.2f);
+        const Vector osc2Level = Vector::broadcast(mix.osc2Level);
+        const Vector osc2LevelStep = Vector::broadcast(mix.osc2LevelStep);
+        const Vector velocity = Vector::broadcast(mix.velocity);
+        const Vector zero = Vector::broadcast(0.0f);
+        int i = 0;
+
+        for (; i + width <= numSamples; i += width) {
+            Vector left = zero;
+            Vector right = zero;
+
+            // Levels of the ramps at these samples; a step of 0 keeps the level exactly
+            const Vector rampIndex = laneIndex + Vector::broadcast(static_cast<float>(i + 1));
+            const Vector osc1SampleLevel = osc1Level + rampIndex * osc1LevelStep;
+            const Vector osc2SampleLevel = osc2Level + rampIndex * osc2LevelStep;
+
+            for (int c = 0; c < mix.unison; ++c) {
+                Vector osc = zero;
+
+                if (mix.osc1Outputs != nullptr) {
+                    osc = osc + Vector::load(mix.osc1Outputs + c * stride + i) * osc1Gain * osc1SampleLevel;
+                }
+
+                if (mix.osc2Outputs != nullptr) {
+                    if (mix.ringMod) {
+                        osc = osc * (Vector::load(mix.osc2Outputs + c * stride + i) * osc2SampleLevel);
+                    }
+                    else {
+                        osc = osc - Vector::load(mix.osc2Outputs + c * stride + i) * osc2Gain * osc2SampleLevel;
+                    }
+                }
+
+                left = left + osc * Vector::broadcast(mix.leftGains[c]);
+
+                if (stereo) {
+                    right = right + osc * Vector::broadcast(mix.rightGains[c]);
+                }
+            }
+
+            const typename Vector::Mask playing = Vector::greaterThan(Vector::broadcast(static_cast<float>(mix.oscSamples - i)), laneIndex);
+            const Vector noise = mix.noise != nullptr ? Vector::load(mix.noise + i) : zero;
+
+            // Velocity amplitude modifier, then noise
+            (Vector::select(playing, left, zero) * velocity + noise).store(output + i);
+
+            if (stereo) {
+                (Vector::select(playing, right, zero) * velocity + noise).store(rightOutput + i);
+            }
+        }
+
+        for (; i < numSamples; ++i) {
+            float left = 0.0f;
+            float right = 0.0f;
+            const float osc1SampleLevel = mix.osc1Level + static_cast<float>(i + 1) * mix.osc1LevelStep;
+            const float osc2SampleLevel = mix.osc2Level + static_cast<float>(i + 1) * mix.osc2LevelStep;
+
+            if (i < mix.oscSamples) {
+                for (int c = 0; c < mix.unison; ++c) {
+                    float osc = 0.0f;
+
+                    if (mix.osc1Outputs != nullptr) {
+                        osc += mix.osc1Outputs[c * stride + i] * mix.osc1Gain * osc1SampleLevel;
+                    }
+
+                    if (mix.osc2Outputs != nullptr) {
+                        if (mix.ringMod) {
+                            osc *= mix.osc2Outputs[c * stride + i] * osc2SampleLevel;
+                        }
+                        else {
+                            osc -= mix.osc2Outputs[c * stride + i] * 0.2f * osc2SampleLevel;
+                        }
+                    }
+
+                    left += osc * mix.leftGains[c];
+
+                    if (stereo) {
+                        right += osc * mix.rightGains[c];
+                    }
+                }
+            }
+
+            const float noise = mix.noise != nullptr ? mix.noise[i] : 0.0f;
+            output[i] = left * mix.velocity + noise;
+
+            if (stereo) {
+                rightOutput[i] = right * mix.velocity + noise;
+            }
+        }
+    }
+
+    static void addMultiplied(float* output, const float* input, const float* gains, int numSamples)
+    {
+        int i = 0;
+
+        for (; i + width <= numSamples; i += width) {
+            (Vector::load(output + i) + Vector::load(input + i) * Vector::load(gains + i)).store(output + i);
+        }
+
+        for (; i < numSamples; ++i) {
+            output[i] += input[i] * gains[i];
+        }
+    }
+
+    static void decimate(const float* input, float* output, float* history, int numSamples, int factor)
+    {
+        if (factor == 2) {
+            decimateBy<2>(input, output, history, numSamples);
+        }
+        else {
+            decimateBy<4>(input, output, history, numSamples);
+        }
+    }
+
+private:
+    using UInt = typename Vector::UInt;
+    static constexpr int width { Vector::width };
+    static constexpr int maxSamples { constants::LOWER_UPDATE_RATE_MAX_VALUE };
+
+    /**
+     renderOscillators() (or renderModulatedOscillators()) for an interpolation mode.
+     */
+    template <bool modulated>
+    static void renderOscillatorsWithMode(WavetableOscillator::Lane* lanes, int numLanes, int numSamples, interpolation::Mode mode)
+    {
+        switch (mode) {
+            case interpolation::truncation:
+                renderOscillatorsWith<interpolation::Truncation, modulated>(lanes, numLanes, numSamples);
+                break;
+            case interpolation::cubicHermite:
+                renderOscillatorsWith<interpolation::CubicHermite, modulated>(lanes, numLanes, numSamples);
+                break;
+            case interpolation::lagrange:
+                renderOscillatorsWith<interpolation::Lagrange, modulated>(lanes, numLanes, numSamples);
+                break;
+            default:
+                renderOscillatorsWith<interpolation::Linear, modulated>(lanes, numLanes, numSamples);
+                break;
+        }
+    }
+
+    /**
+     renderOscillators() for one interpolation policy (see InterpolationPolicies.h), with the phase modulation of the
+     lanes when modulated is true.
+     */
+    template <typename Interpolation, bool modulated>
+    static void renderOscillatorsWith(WavetableOscillator::Lane* lanes, int numLanes, int numSamples)
+    {
+        jassert(numSamples <= maxSamples);
+
+        alignas(64) float block[maxSamples * width]; // the samples of a group, lane after lane for every sample
+        alignas(64) float modulationBlock[modulated ? maxSamples * width : 1]; // same layout, for the modulations
+        WavetableOscillator::Lane padding[width];
+        float paddingOutput[maxSamples];
+
+        for (int first = 0; first < numLanes; first += width) {
+            WavetableOscillator::Lane* group[width];
+            makeGroup(lanes, first, numLanes, group, padding, paddingOutput);
+
+            alignas(64) uint32_t phases[width];
+            alignas(64) uint32_t increments[width];
+            alignas(64) uint32_t indexes[width];
+            alignas(64) uint32_t nextIndexes[width];
+            alignas(64) float weights[width];
+            alignas(64) float depths[width];
+            const WavetableSample* frameTables[width];
+            const WavetableSample* nextFrameTables[width];
+            const float* modulations[width];
+            float* outputs[width];
+
+            for (int l = 0; l < width; ++l) {
+                phases[l] = group[l]->phase;
+                increments[l] = group[l]->phaseIncrement;
+                weights[l] = group[l]->nextFrameWeight;
+                frameTables[l] = group[l]->frameTable;
+                nextFrameTables[l] = group[l]->nextFrameTable;
+                outputs[l] = group[l]->output;
+                
+                // Depths in 1/2^24 of a period, see below
+                depths[l] = group[l]->phaseModulationDepth * 16777216.0f;
+                modulations[l] = group[l]->phaseModulation;
+            }
+            
+            if constexpr (modulated) {
+                Vector::transposeFromLanes(modulations, modulationBlock, numSamples);
+            }
+
+            UInt phase = UInt::load(phases);
+            const UInt increment = UInt::load(increments);
+            const UInt fractionMask = UInt::broadcast(WavetableOscillator::fractionMask);
+            const Vector fractionScale = Vector::broadcast(WavetableOscillator::fractionScale);
+            const Vector nextFrameWeight = Vector::load(weights);
+            const Vector depth = Vector::load(depths);
+            
+            // One sample in phase units, forwards and backwards (adding 2^32 - step wraps like subtracting step)
+            const UInt sampleStep = UInt::broadcast(1u << WavetableOscillator::fractionBits);
+            const UInt sampleStepBack = UInt::broadcast(0u - (1u << WavetableOscillator::fractionBits));
+
+            for (int i = 0; i < numSamples; ++i) {
+                UInt samplePhase = phase;
+                
+                if constexpr (modulated) {
+                    // The offset is rounded to 24 fractional bits (about the precision of a float near 1 period),
+                    //  which covers 128 periods each way, then moved to the 32 bits of the phase, where it wraps
+                    samplePhase = phase + (Vector::load(modulationBlock + i * width) * depth).roundToInt().template shiftLeft<8>();
+                }
+                
+                // The fraction fits in 21 bits, so the signed conversion is exact
+                const Vector fraction = (samplePhase & fractionMask).toFloat() * fractionScale;
+
+                Vector frameSample, nextFrameSample;
+
+                if constexpr (Interpolation::points == 4) {
+                    // Both pairs around the sample before the phase; the indexes wrap around the table like the
+                    //  phase, and the guard sample completes the last pair
+                    (samplePhase + sampleStepBack).template shiftRight<WavetableOscillator::fractionBits>().store(indexes);
+                    (samplePhase + sampleStep).template shiftRight<WavetableOscillator::fractionBits>().store(nextIndexes);
+
+                    Vector framePrevious, frameCurrent, frameNext, frameAfterNext;
+                    Vector::fetchPairs(frameTables, indexes, framePrevious, frameCurrent);
+                    Vector::fetchPairs(frameTables, nextIndexes, frameNext, frameAfterNext);
+                    frameSample = Interpolation::interpolate(framePrevious, frameCurrent, frameNext, frameAfterNext, fraction);
+
+                    Vector nextFramePrevious, nextFrameCurrent, nextFrameNext, nextFrameAfterNext;
+                    Vector::fetchPairs(nextFrameTables, indexes, nextFramePrevious, nextFrameCurrent);
+                    Vector::fetchPairs(nextFrameTables, nextIndexes, nextFrameNext, nextFrameAfterNext);
+                    nextFrameSample = Interpolation::interpolate(nextFramePrevious, nextFrameCurrent, nextFrameNext,
+                                                                 nextFrameAfterNext, fraction);
+                }
+                else {
+                    samplePhase.template shiftRight<WavetableOscillator::fractionBits>().store(indexes);
+
+                    Vector frameCurrent, frameNext, nextFrameCurrent, nextFrameNext;
+                    Vector::fetchPairs(frameTables, indexes, frameCurrent, frameNext);
+                    Vector::fetchPairs(nextFrameTables, indexes, nextFrameCurrent, nextFrameNext);
+
+                    frameSample = Interpolation::interpolate(frameCurrent, frameCurrent, frameNext, frameNext, fraction);
+                    nextFrameSample = Interpolation::interpolate(nextFrameCurrent, nextFrameCurrent, nextFrameNext,
+                                                                 nextFrameNext, fraction);
+                }
+
+                (frameSample + (nextFrameSample - frameSample) * nextFrameWeight).store(block + i * width);
+
+                phase = phase + increment;
+            }
+
+            phase.store(phases);
+
+            for (int l = 0; l < width; ++l) {
+                group[l]->phase = phases[l];
+            }
+
+            Vector::transposeToLanes(block, outputs, numSamples);
+        }
+    }
+
+    /**
+     decimate() for a factor. The input is split in factor phases (every factor-th sample), so each tap of the filter
+     reads consecutive samples of a phase, and a vector holds consecutive outputs.
+     */
+    template <int factor>
+    static void decimateBy(const float* input, float* output, float* history, int numSamples)
+    {
+        jassert(numSamples <= maxSamples);
+
+        constexpr int phaseTaps { SimdKernels::decimationTapsPerPhase };
+        const float* filter = SimdKernels::getDecimationFilter(factor);
+
+        // The history, then the input: sample m * factor + p is phases[p][m]
+        alignas(64) float phases[factor][phaseTaps + maxSamples];
+
+        for (int m = 0; m < phaseTaps; ++m) {
+            for (int p = 0; p < factor; ++p) {
+                phases[p][m] = history[m * factor + p];
+            }
+        }
+
+        for (int m = 0; m < numSamples; ++m) {
+            for (int p = 0; p < factor; ++p) {
+                phases[p][phaseTaps + m] = input[m * factor + p];
+            }
+        }
+
+        // Output n is the sum of tap k times the sample k samples before the last input sample of its period: for
+        //  tap i * factor + r, it is sample phaseTaps + n - i of phase factor - 1 - r
+        int n = 0;
+
+        for (; n + width <= numSamples; n += width) {
+            Vector sum = Vector::broadcast(0.0f);
+
+            for (int i = 0; i < phaseTaps; ++i) {
+                for (int r = 0; r < factor; ++r) {
+                    sum = sum + Vector::broadcast(filter[i * factor + r]) * Vector::load(&phases[factor - 1 - r][phaseTaps + n - i]);
+                }
+            }
+
+            sum.store(output + n);
+        }
+
+        for (; n < numSamples; ++n) {
+            float sum = 0.0f;
+
+            for (int i = 0; i < phaseTaps; ++i) {
+                for (int r = 0; r < factor; ++r) {
+                    sum += filter[i * factor + r] * phases[factor - 1 - r][phaseTaps + n - i];
+                }
+            }
+
+            output[n] = sum;
+        }
+
+        // The last input samples are the history of the next call
+        for (int m = 0; m < phaseTaps; ++m) {
+            for (int p = 0; p < factor; ++p) {
+                history[m * factor + p] = phases[p][numSamples + m];
+            }
+        }
+    }
+
+    /**
+     Points group to the width lanes starting at first. When there are not enough lanes left, the group is completed
+     with copies of the first lane that write their output in paddingOutput.
+     */
+    template <typename Lane>
+    static void makeGroup(Lane* lanes, int first, int numLanes, Lane** group, Lane* padding, float* paddingOutput)
+    {
+        for (int l = 0; l < width; ++l) {
+            if (first + l < numLanes) {
+                group[l] = &lanes[first + l];
+            }
+            else {
+                padding[l] = lanes[first];
+                padding[l].output = paddingOutput;
+                group[l] = &padding[l];
+            }
+        }
+    }
+};
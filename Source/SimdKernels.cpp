@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    SimdKernels.cpp
+    Created: 13 Oct 2026 11:02:44am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "SimdKernels.h"
+#include <array>
+#include <cmath>
+
+namespace
+{
+    /**
+     Designs the low-pass filter decimating by a factor: a windowed sinc cut at the Nyquist frequency of the
+     decimated signal, so whatever goes through the transition band only folds back above the passband. The Kaiser
+     window (beta 6) gives about 60 dB of attenuation in the stop band.
+     */
+    template <int factor>
+    std::array<float, factor * SimdKernels::decimationTapsPerPhase> designDecimationFilter()
+    {
+        constexpr int length { factor * SimdKernels::decimationTapsPerPhase };
+        constexpr double beta { 6.0 };
+        const double pi = juce::MathConstants<double>::pi;
+        
+        // LRN the Kaiser window uses the modified Bessel function of the first kind I0, which is its power series
+        const auto besselI0 = [] (double x) {
+            double sum = 1.0, term = 1.0;
+            
+            for (int k = 1; k < 32; ++k) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            
+            return sum;
+        };
+        
+        std::array<double, length> taps {};
+        double tapsSum = 0.0;
+        
+        for (int k = 0; k < length; ++k) {
+            const double position = k - (length - 1) / 2.0; // around the center of the filter
+            const double x = pi * position / factor;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(x) / x;
+            const double ratio = 2.0 * position / (length - 1);
+            taps[k] = sinc * besselI0(beta * std::sqrt(1.0 - ratio * ratio)) / besselI0(beta);
+            tapsSum += taps[k];
+        }
+        
+        // Unity gain at 0 Hz
+        std::array<float, length> filter {};
+        
+        for (int k = 0; k < length; ++k) {
+            filter[k] = static_cast<float>(taps[k] / tapsSum);
+        }
+        
+        return filter;
+    }
+    
+    // Designed when the plugin is loaded, away from the audio thread
+    const auto decimationFilter2 = designDecimationFilter<2>();
+    const auto decimationFilter4 = designDecimationFilter<4>();
+}
+
+const SimdKernels& SimdKernels::select()
+{
+    // The processor does not change while the plugin runs, so the choice is only made once
+    static const SimdKernels& selected = [] () -> const SimdKernels& {
+        for (int level = numLevels - 1; level > scalar; --level) {
+            if (const SimdKernels* kernels = get(static_cast<Level>(level))) {
+                return *kernels;
+            }
+        }
+
+        return getScalarKernels();
+    }();
+
+    return selected;
+}
+
+const SimdKernels* SimdKernels::get(Level level)
+{
+    if (level > CPPSYNTH_SIMD_MAX_LEVEL) {
+        return nullptr;
+    }
+
+    switch (level) {
+        case sse2: {
+            return juce::SystemStats::hasSSE2() ? getSSE2Kernels() : nullptr;
+        }
+        case avx2: {
+            // Every processor with AVX2 and FMA also has F16C, which JUCE does not report
+            return (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3()) ? getAVX2Kernels() : nullptr;
+        }
+        case avx512: {
+            return juce::SystemStats::hasAVX512F() ? getAVX512Kernels() : nullptr;
+        }
+        default: { // scalar
+            return &getScalarKernels();
+        }
+    }
+}
+
+const float* SimdKernels::getDecimationFilter(int factor)
+{
+    jassert(factor == 2 || factor == 4);
+    return factor == 2 ? decimationFilter2.data() : decimationFilter4.data();
+}
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    SimdKernels.h
+    Created: 13 Oct 2026 11:02:44am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Constants.h"
+#include "WavetableOscillator.h"
+#include "AdditiveOscillator.h"
+#include "Envelope.h"
+#include "StateVariableFilter.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+ #define CPPSYNTH_SIMD_X86 1
+#else
+ #define CPPSYNTH_SIMD_X86 0
+#endif
+
+/**
+ Highest instruction set the kernels may use (see SimdKernels::Level), whatever the processor supports.
+ Set it in the exporter's preprocessor definitions to cap a deployment, or to compare the kernels on one machine.
+ */
+#ifndef CPPSYNTH_SIMD_MAX_LEVEL
+ #define CPPSYNTH_SIMD_MAX_LEVEL 3
+#endif
+
+/**
+ This class holds the hot loops of the synth (oscillators, envelopes, filters and mixing), compiled for one
+ instruction set. Every set of kernels is built in the same binary from the same code (SimdKernelSet) with a
+ different SIMD wrapper, and select() picks the fastest one the processor supports at run time, so a single build
+ runs at the best speed of every machine.
+
+ The oscillators, envelopes and filters of several voices are rendered together, one per SIMD lane. The state of
+ the oscillators is copied to lanes before a block and given back afterwards; the envelopes and filters keep theirs
+ in arrays of one slot per voice, loaded a vector at a time. Mixing works on consecutive samples of a voice.
+ Buffers hold at most constants::LOWER_UPDATE_RATE_MAX_VALUE samples.
+ */
+class SimdKernels
+{
+public:
+    // Instruction sets, from slowest to fastest
+    enum Level
+    {
+        scalar = 0,
+        sse2,
+        avx2, // with FMA and F16C
+        avx512,
+        numLevels
+    };
+
+    /**
+     What a voice mixes before its filters: both oscillators of every unison copy, placed in the stereo field,
+     then velocity and noise. The oscillator levels ramp from their value before the chunk, so they change without
+     clicks: sample i has osc1Level + (i + 1) * osc1LevelStep.
+     */
+    struct OscillatorMix
+    {
+        const float* osc1Outputs; // every copy of OSC1, oscOutputsStride samples apart; nullptr when OSC1 is not playing
+        const float* osc2Outputs; // every copy of OSC2, oscOutputsStride samples apart; nullptr when OSC2 is not playing
+        const float* noise; // nullptr for no noise
+        const float* leftGains; // gain of every copy in the left channel (the only one of a mono voice)
+        const float* rightGains; // gain of every copy in the right channel; nullptr for a mono voice
+        int unison; // number of copies
+        float osc1Gain;
+        float osc1Level;
+        float osc2Level;
+        float osc1LevelStep;
+        float osc2LevelStep;
+        float velocity;
+        bool ringMod;
+        int oscSamples; // samples where the oscillators play; they are silent afterwards
+    };
+    
+    // Distance between the outputs of two oscillator copies in OscillatorMix
+    static constexpr int oscOutputsStride { constants::LOWER_UPDATE_RATE_MAX_VALUE };
+
+    // Largest difference with the scalar kernels for signals in [-2, 2], which only come from multiply-adds the
+    //  compiler fuses in the kernels compiled for FMA; measured by Benchmarks::reportSimdKernels()
+    static constexpr float tolerance { 1.0e-4f };
+    
+    // Largest difference of renderOscillators() with WavetableOscillator::renderBlock(), for samples in [-1, 1]: the
+    //  same interpolation, where a fused multiply-add only changes the last bits of the result (2.4e-7 measured by
+    //  Benchmarks::reportSimdKernels() with AVX2)
+    static constexpr float renderBlockTolerance { 1.0e-6f };
+
+    Level level;
+    const char* name;
+    int width; // lanes per vector
+
+    /**
+     Renders numSamples samples of every oscillator lane in its output with an interpolation mode, and advances
+     their phase.
+     */
+    void (*renderOscillators)(WavetableOscillator::Lane* lanes, int numLanes, int numSamples, interpolation::Mode mode);
+
+    /**
+     Same as renderOscillators, with the phase of every sample of every lane moved by the lane's phaseModulation.
+     */
+    void (*renderModulatedOscillators)(WavetableOscillator::Lane* lanes, int numLanes, int numSamples, interpolation::Mode mode);
+
+    /**
+     Renders numSamples samples of the sum of an additive oscillator's partials in output, from their state at the
+     first sample; the state is not advanced.
+     */
+    void (*renderPartials)(const AdditiveOscillator::Partials& partials, float* output, int numSamples);
+    
+    /**
+     Renders at most numSamples samples of the envelopes of the slots [firstSlot, endSlot) of states, slot s in
+     outputs + s * outputsStride: an envelope stops after the sample where it becomes inactive, and gives the number
+     of samples it rendered in activeSamples. Inactive envelopes are left as they are. firstSlot is a multiple of
+     width, so separate ranges never share a vector and can be rendered by different threads.
+     */
+    void (*renderEnvelopes)(Envelope::States& states, int firstSlot, int endSlot, float* outputs, int outputsStride,
+                            int numSamples);
+
+    /**
+     Filters the samples prepared for the filters of the slots [firstSlot, endSlot) of states (see
+     StateVariableFilter::prepareBlock); firstSlot is a multiple of width. The outputs must have room for the
+     samples of the longest block of their vector of slots; what follows the block's own samples is undefined.
+     */
+    void (*renderFilters)(StateVariableFilter::States& states, int firstSlot, int endSlot);
+
+    /**
+     Mixes the oscillators of a voice in output, with velocity and noise; the right channel of a stereo voice
+     goes to rightOutput, which is not used for a mono voice.
+     */
+    void (*mixOscillators)(const OscillatorMix& mix, float* output, float* rightOutput, int numSamples);
+
+    /**
+     Adds input multiplied by gains (one gain per sample) to output.
+     */
+    void (*addMultiplied)(float* output, const float* input, const float* gains, int numSamples);
+
+    /**
+     Low-pass filters the factor * numSamples samples of input, oversampled factor times (2 or 4), and keeps one
+     sample out of factor in output, with a polyphase filter (see getDecimationFilter()). history holds the last
+     input samples of the previous call (decimationHistoryLength(factor) of them, zeros to start from silence), and
+     is updated.
+     */
+    void (*decimate)(const float* input, float* output, float* history, int numSamples, int factor);
+
+    // Taps of every phase of the decimation filters; a filter decimating by a factor has factor times as many taps
+    static constexpr int decimationTapsPerPhase { 16 };
+
+    /**
+     Returns the input samples decimate() keeps between calls for a factor.
+     */
+    static constexpr int decimationHistoryLength(int factor) { return factor * decimationTapsPerPhase; }
+    
+    /**
+     Returns how late the output of decimate() is for a factor, in output samples: the filter is centered
+     (decimationHistoryLength(factor) - 1) / 2 input samples before the last input sample of every output's period.
+     */
+    static constexpr float decimationDelay(int factor)
+    {
+        return (static_cast<float>(decimationHistoryLength(factor) - 1) * 0.5f - static_cast<float>(factor - 1))
+             / static_cast<float>(factor);
+    }
+
+    /**
+     Returns the taps of the low-pass filter of decimate() for a factor (2 or 4).
+     */
+    static const float* getDecimationFilter(int factor);
+
+    /**
+     Returns the fastest kernels supported by this processor (and allowed by CPPSYNTH_SIMD_MAX_LEVEL).
+     */
+    static const SimdKernels& select();
+
+    /**
+     Returns the kernels of an instruction set, or nullptr if they are not built for this processor architecture,
+     not supported by this processor, or above CPPSYNTH_SIMD_MAX_LEVEL.
+     */
+    static const SimdKernels* get(Level level);
+
+private:
+    // Each set is defined in its own file, compiled for its instruction set; they return nullptr when they are
+    //  not built for this processor architecture
+    static const SimdKernels& getScalarKernels();
+    static const SimdKernels* getSSE2Kernels();
+    static const SimdKernels* getAVX2Kernels();
+    static const SimdKernels* getAVX512Kernels();
+};
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    SimdKernelsAVX512.cpp
+    Created: 13 Oct 2026 12:29:02pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "SimdKernels.h"
+
+#if CPPSYNTH_SIMD_X86
+
+#include "SimdFloat4.h"
+
+/*
+ Everything below is compiled for AVX-512F, whatever the options of the rest of the project; the
+ kernels are only called when SimdKernels::get() found these instructions on the processor.
+ LRN GCC and Clang only accept the intrinsics of an instruction set in functions compiled for it, which is what
+  these pragmas do; MSVC accepts them anywhere. The headers shared with other files are included before them.
+ */
+#if defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("avx512f,avx2,fma,f16c"))), apply_to = function)
+#elif defined(__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target("avx512f,avx2,fma,f16c")
+#endif
+
+#include "SimdFloat16.h"
+#include "SimdKernelSet.h"
+
+const SimdKernels* SimdKernels::getAVX512Kernels()
+{
+    static const SimdKernels kernels = SimdKernelSet<simd::float16>::create(avx512, "AVX-512");
+    return &kernels;
+}
+
+#if defined(__clang__)
+ #pragma clang attribute pop
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+#else
+
+const SimdKernels* SimdKernels::getAVX512Kernels()
+{
+    return nullptr;
+}
+
+#endif
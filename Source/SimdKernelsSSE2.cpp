@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    SimdKernelsSSE2.cpp
+    Created: 13 Oct 2026 12:04:51pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "SimdKernels.h"
+
+#if CPPSYNTH_SIMD_X86
+
+// Every x86-64 processor has SSE2, so this file needs no special compiler option
+#include "SimdFloat4.h"
+#include "SimdKernelSet.h"
+
+const SimdKernels* SimdKernels::getSSE2Kernels()
+{
+    static const SimdKernels kernels = SimdKernelSet<simd::float4>::create(sse2, "SSE2");
+    return &kernels;
+}
+
+#else
+
+const SimdKernels* SimdKernels::getSSE2Kernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,19 @@
+/*
+  ==============================================================================
+
+    SimdKernelsScalar.cpp
+    Created: 13 Oct 2026 11:58:23am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "SimdKernels.h"
+#include "SimdFloat1.h"
+#include "SimdKernelSet.h"
+
+const SimdKernels& SimdKernels::getScalarKernels()
+{
+    static const SimdKernels kernels = SimdKernelSet<simd::float1>::create(scalar, "scalar");
+    return kernels;
+}
@@ -10,14 +10,46 @@
 
 #pragma once
 
+#include <array>
+#include "Constants.h"
+
 class StateVariableFilter
 {
     /**
      The state-variable filter implemented here is from : https://cytomic.com/files/dsp/SvfLinearTrapOptimised2.pdf
+     The coefficiants and the state it renders with live in States, next to those of the other voices' filters; a
+     filter is a view of its slot there.
      */
 public:
     float sampleRate; // copy of the synths's sample rate
     
+    // Slots of States: the left channel of every voice, then the right channel of every voice
+    static constexpr int slotsCount { 2 * constants::VOICE_SLOTS };
+    
+    /**
+     Coefficiants and state of the filters of every voice, rendered by the SIMD kernels a vector of slots at a time.
+     A filter renders a block once prepared with prepareBlock; the kernels then set numSamples back to 0, so the slots
+     that are not prepared again are left alone.
+     */
+    struct States
+    {
+        alignas(64) std::array<float, slotsCount> a1 {}, a2 {}, a3 {};
+        alignas(64) std::array<float, slotsCount> m0 {}, m1 {}, m2 {};
+        alignas(64) std::array<float, slotsCount> ic1eq {}, ic2eq {}; // internal state for current sample
+        alignas(64) std::array<const float*, slotsCount> inputs {};
+        alignas(64) std::array<float*, slotsCount> outputs {}; // may be the inputs, to filter in place
+        alignas(64) std::array<int, slotsCount> numSamples {};
+    };
+    
+    /**
+     Makes this filter the view of a slot of states, which must stay alive as long as it is used.
+     */
+    void bind(States& newStates, int newSlot)
+    {
+        states = &newStates;
+        slot = newSlot;
+    }
+    
     /**
      Tick function of the filter.
      */
@@ -33,6 +65,10 @@ public:
      */
     float render(float v0)
     {
+        const float a1 = states->a1[slot], a2 = states->a2[slot], a3 = states->a3[slot];
+        float& ic1eq = states->ic1eq[slot];
+        float& ic2eq = states->ic2eq[slot];
+        
         // voltages at nodes
         float v3 = v0 - ic2eq;
         float v1 = a1 * ic1eq + a2 * v3; // voltage for band-pass output
@@ -41,11 +77,70 @@ public:
         ic1eq = 2.0f * v1 - ic1eq;
         ic2eq = 2.0f * v2 - ic2eq;
         
-        return m0 * v0 + m1 * v1 + m2 * v2;
+        return states->m0[slot] * v0 + states->m1[slot] * v1 + states->m2[slot] * v2;
+    }
+    
+    /**
+     Gives this filter the coefficiants of another one, keeping its own state; used for the second channel of a
+     stereo voice, which is filtered like the first one.
+     */
+    void copyCoefficiants(const StateVariableFilter& other)
+    {
+        g = other.g;
+        k = other.k;
+        setCoefficiants(other.states->a1[other.slot], other.states->a2[other.slot], other.states->a3[other.slot]);
+        setMix(other.states->m0[other.slot], other.states->m1[other.slot], other.states->m2[other.slot]);
+    }
+    
+    /**
+     Gives this filter the state of another one; the right channel of a voice starts from the left one this way.
+     */
+    void copyState(const StateVariableFilter& other)
+    {
+        states->ic1eq[slot] = other.states->ic1eq[other.slot];
+        states->ic2eq[slot] = other.states->ic2eq[other.slot];
+    }
+    
+    /**
+     Clears the internal state, keeping the coefficiants; the filter then starts from silence.
+     */
+    void clearState()
+    {
+        states->ic1eq[slot] = 0.0f;
+        states->ic2eq[slot] = 0.0f;
+    }
+    
+    /**
+     Makes the SIMD kernels filter the first numSamples samples of input in output at their next call.
+     */
+    void prepareBlock(const float* input, float* output, int numSamples)
+    {
+        states->inputs[slot] = input;
+        states->outputs[slot] = output;
+        states->numSamples[slot] = numSamples;
     }
     
 protected:
-    float g, k, a1, a2, a3; // filter coefficiants
-    float ic1eq, ic2eq; // internal state for current sample
-    float m0, m1, m2; // coefficiants that determine which type of filter is used (low, high, notch, etc.)
+    float g, k; // filter coefficiants the others are calculated from
+    
+    void setCoefficiants(float a1, float a2, float a3)
+    {
+        states->a1[slot] = a1;
+        states->a2[slot] = a2;
+        states->a3[slot] = a3;
+    }
+    
+    /**
+     Sets the coefficiants that determine which type of filter is used (low, high, notch, etc.).
+     */
+    void setMix(float m0, float m1, float m2)
+    {
+        states->m0[slot] = m0;
+        states->m1[slot] = m1;
+        states->m2[slot] = m2;
+    }
+    
+private:
+    States* states = nullptr;
+    int slot = 0;
 };
@@ -10,6 +10,41 @@
 
 #include "Synth.h"
 #include "Utils.h"
+#include "ParallelPreparation.h"
+#include "Benchmarks.h"
+
+namespace
+{
+    /**
+     For every partial number n of the additive engine, its smallest factor above 1 (n itself for a prime) and the
+     octaves it is above the fundamental (log2(n)).
+     */
+    struct PartialNumbers
+    {
+        std::array<int, constants::MAX_PARTIALS + 1> smallestFactors {};
+        std::array<float, constants::MAX_PARTIALS + 1> octaves {};
+    };
+    
+    // Computed when the plugin is loaded, away from the audio thread
+    const PartialNumbers partialNumbers = [] {
+        PartialNumbers numbers;
+        
+        for (int n = 2; n <= constants::MAX_PARTIALS; ++n) {
+            numbers.octaves[n] = std::log2(static_cast<float>(n));
+            
+            // A number that no smaller prime has marked is a prime: it is the smallest factor of its unmarked multiples
+            if (numbers.smallestFactors[n] == 0) {
+                for (int multiple = n; multiple <= constants::MAX_PARTIALS; multiple += n) {
+                    if (numbers.smallestFactors[multiple] == 0) {
+                        numbers.smallestFactors[multiple] = n;
+                    }
+                }
+            }
+        }
+        
+        return numbers;
+    }();
+}
 
 Synth::Synth()
 {
@@ -17,19 +52,68 @@ Synth::Synth()
     sampleRate = 44100.0f;
 }
 
+Synth::~Synth()
+{
+    // The audio thread is stopped, so its state can be freed here
+    delete engineState;
+}
+
 // LRN trailing _ here used to distinguish with private member sampleRate
-void Synth::allocateResources(double sampleRate_, int /*samplesPerBlock*/) {
+void Synth::allocateResources(double sampleRate_, int samplesPerBlock) {
     // LRN static_cast has more compile-time checks than regular cast, and is safer
     sampleRate = static_cast<float>(sampleRate_);
     
-    // Pass sample rate to various components of voices
-    for (int v = 0; v < constants::MAX_VOICES; ++v) {
-        // Give sampleRate to voices filters to calculate coefficiants
-        voices[v].lpf.sampleRate = sampleRate;
-        voices[v].hpf.sampleRate = sampleRate;
+    // The render workers wait a whole block for the next one before they sleep
+    workerPool->setSpinTime(samplesPerBlock / sampleRate_);
+    
+    // The kernels for the instruction sets of this processor are chosen before rendering starts
+    kernels = &SimdKernels::select();
+    
+    if (!oscillatorsAllocated) {
+        // Nothing is rendering yet, so the oscillators can be created right away with the wavetables
+        //  shared by every synth instance running at this sample rate
+        auto bank = WavetableBank::getSharedBank(sampleRate);
+        
+        // Every voice is created now, whatever the polyphony, so changing it never allocates on the audio thread;
+        //  each one renders its envelopes and filters in its own slot of the voices' states
+        voices.resize(constants::MAX_VOICES);
+        
+        for (int v = 0; v < constants::MAX_VOICES; ++v) {
+            voices[v].bind(voiceStates, v);
+        }
+        
+        // The working buffers of a chunk have room for every voice playing at once
+        constexpr int voiceOscOutputsSize { 2 * constants::MAX_UNISON * SimdKernels::oscOutputsStride };
+        oscLanes.resize(2 * constants::MAX_UNISON * constants::MAX_VOICES);
+        oscOutputs.resize(voiceOscOutputsSize * constants::MAX_VOICES);
+        modulatorLanes.resize(constants::MAX_UNISON * constants::MAX_VOICES);
+        carrierLanes.resize(constants::MAX_UNISON * constants::MAX_VOICES);
+        oversampledOscOutputs.resize(constants::MAX_FM_OVERSAMPLING * voiceOscOutputsSize * constants::MAX_VOICES);
+        envelopes.resize(constants::VOICE_SLOTS);
+        static_assert(sizeof(SegmentBuffer) == constants::MAX_SEGMENT_SAMPLES * sizeof(float), "Envelopes are one segment apart");
+        voiceOutputs.resize(constants::MAX_VOICES);
+        voiceRightOutputs.resize(constants::MAX_VOICES);
         
-        // Initialize wavetables with sample rate
-        voices[v].initializeOscillators(sampleRate);
+        // Voices don't share anything but the bank, so they are prepared in parallel
+        ParallelPreparation::run(constants::MAX_VOICES, [this, &bank](int v) {
+            // Give sampleRate to voices filters to calculate coefficiants
+            voices[v].lpf.sampleRate = sampleRate;
+            voices[v].hpf.sampleRate = sampleRate;
+            
+            // Initialize oscillators with the shared wavetables and sample rate
+            voices[v].initializeOscillators(*bank, sampleRate);
+        });
+        
+        engineStateBuilder.publishNow(sampleRate, std::move(bank));
+        oscillatorsAllocated = true;
+        
+       #if CPPSYNTH_BENCHMARKS
+        Benchmarks::runOnce(sampleRate);
+       #endif
+    }
+    else {
+        // The audio thread may still be rendering; the new state is swapped in at the start of its next block
+        engineStateBuilder.requestSampleRate(sampleRate);
     }
 }
 
@@ -37,13 +121,22 @@ void Synth::deallocateResources()
 {
 }
 
+void Synth::prepareRenderThreads(int renderThreads_)
+{
+    if (renderThreads_ > 1) {
+        workerPool->startWorkers();
+    }
+}
+
 void Synth::reset()
 {
     // Reset voices
-    for (int v = 0; v < constants::MAX_VOICES; ++v) {
-        voices[v].reset();
+    for (Voice& voice : voices) {
+        voice.reset();
     }
     
+    playingVoicesCount = 0;
+    
     // Reset noise generators
     whiteNoise.reset();
     pinkNoise.reset();
@@ -52,6 +145,8 @@ void Synth::reset()
     pitchBend = 1.0f;
     sustainPressed = false;
     outputLevelSmoother.reset(sampleRate, 0.05); // 50 msec
+    noiseLevelSmoother.reset(constants::RAMP_SAMPLES);
+    noiseLevelSmoother.setCurrentAndTargetValue(0.0f);
     lfo = 0.0f;
     lfoStep = 0;
     modWheel = 0;
@@ -68,22 +163,22 @@ void Synth::reset()
 
 void Synth::render(float** outputBuffers, int sampleCount)
 {
+    // Swap in the engine state prepared for a new sample rate, if any
+    if (EngineState* newState = engineStateBuilder.takeNewState()) {
+        adoptEngineState(newState);
+    }
+    
     float* outputBufferLeft = outputBuffers[0];
     float* outputBufferRight = outputBuffers[1];
 
-    // Update some of the synth's currently playing voices to catch param changes
-    for (int v = 0; v < constants::MAX_VOICES; ++v) {
-        Voice& voice = voices[v];
-        
-        // Update some voice toggles
-        voice.ringMod = ringMod;
-        voice.phaseRand = phaseRand;
-        
-        // Update OSC settings
-        voice.osc1Morph = osc1Morph;
-        voice.osc2Morph = osc2Morph;
-        voice.osc1Level = osc1Level;
-        voice.osc2Level = osc2Level;
+    const float* partialGains = updateAdditiveGains();
+    noiseLevelSmoother.setTargetValue(noiseLevel);
+    updatePolyphony();
+    
+    // Update the synth's currently playing voices to catch param changes; the others get them when they start
+    for (int n = 0; n < playingVoicesCount; ++n) {
+        Voice& voice = voices[playingVoices[n]];
+        applyOscillatorSettings(voice, partialGains);
         
         if (voice.env.isActive()) {
             // Update modulation on frequency
@@ -101,69 +196,329 @@ void Synth::render(float** outputBuffers, int sampleCount)
         }
     }
         
-    // For all the samples we need to render (sampleCount)...
-    for (int sample = 0; sample < sampleCount; ++sample) {
-        // Update LFO first
-        updateLFO();
+    // Render in segments, which the voices render one after the other before they are mixed down
+    int sample = 0;
+    
+    while (sample < sampleCount) {
+        const int segmentSize = std::min(sampleCount - sample, constants::MAX_SEGMENT_SAMPLES);
         
-        // Get next noise value
-        float noise;
-        switch (noiseType) {
-            case 0: { // White
-                noise = whiteNoise.getSample() * noiseLevel;
-                break;
-            }
-            case 1: { // Pink
-                noise = pinkNoise.getSample() * noiseLevel;
-                break;
-            }
-        }
+        renderSegment(outputBufferLeft + sample,
+                      outputBufferRight != nullptr ? outputBufferRight + sample : nullptr,
+                      segmentSize);
         
-        float outputLeft = 0.0f;
-        float outputRight = 0.0f;
+        sample += segmentSize;
+    }
+    
+    // Reset envelope and filter of the voices that are done
+    retireVoices();
 
-        for (int v = 0; v < constants::MAX_VOICES; ++v) {
-            Voice& voice = voices[v];
+    // Protect buffers from loudness
+//    loudnessProtectBuffer(outputBufferLeft, sampleCount);
+//    loudnessProtectBuffer(outputBufferRight, sampleCount);
+}
+
+void Synth::renderSegment(float* outputBufferLeft, float* outputBufferRight, int sampleCount)
+{
+    for (int n = 0; n < playingVoicesCount; ++n) {
+        voiceSegmentSamples[playingVoices[n]] = 0;
+    }
+    
+    // Split in chunks that end where the LFO is updated, so the modulations stay the same in every chunk
+    segmentChunksCount = 0;
+    int sample = 0;
+    
+    while (sample < sampleCount) {
+        Chunk& chunk = segmentChunks[segmentChunksCount++];
+        
+        // Update LFO first, every LOWER_UPDATE_RATE_MAX_VALUE samples
+        chunk.updatesLFO = lfoStep <= 0;
+        
+        if (chunk.updatesLFO) {
+            lfoStep = constants::LOWER_UPDATE_RATE_MAX_VALUE;
+            updateLFO();
+        }
+        
+        chunk.offset = sample;
+        chunk.sampleCount = std::min(sampleCount - sample, lfoStep);
+        chunk.vibratoMod = vibratoMod;
+        chunk.lpfMod = lpfZip;
+        chunk.hpfMod = hpfZip;
+        lfoStep -= chunk.sampleCount;
+        
+        // Get next noise values, unless the noise is off (and done ramping down), where none is generated or mixed
+        chunk.noiseOn = noiseLevelSmoother.isSmoothing() || noiseLevelSmoother.getTargetValue() != 0.0f;
+        
+        if (chunk.noiseOn) {
+            float* noise = segmentNoise.samples + sample;
             
-            if (voice.env.isActive()) {
-                // Render voice with noise mixed in
-                float output = voice.render(noise);
-                
-                outputLeft += output;
-                outputRight += output;
+            switch (noiseType) {
+                case 0: { // White
+                    for (int i = 0; i < chunk.sampleCount; ++i) {
+                        noise[i] = whiteNoise.getSample() * noiseLevelSmoother.getNextValue();
+                    }
+                    break;
+                }
+                case 1: { // Pink
+                    for (int i = 0; i < chunk.sampleCount; ++i) {
+                        noise[i] = pinkNoise.getSample() * noiseLevelSmoother.getNextValue();
+                    }
+                    break;
+                }
             }
         }
         
-        // Apply output level with smoothing
-        float outputLevel = outputLevelSmoother.getNextValue();
-        outputLeft *= outputLevel;
-        outputRight *= outputLevel;
+        sample += chunk.sampleCount;
+    }
+    
+    // The audio thread takes tasks too, and waits for the others to be done before the mix-down; while the pool
+    //  works for another synth instance, it does them all
+    const int threadsCount = prepareRenderTasks();
+    
+    if (threadsCount > 1) {
+        auto renderTask = [this](int t) { renderVoices(renderTasks[t]); };
+        workerPool->run(renderTasksCount, threadsCount - 1, renderTask);
+    }
+    else if (renderTasksCount > 0) {
+        renderVoices(renderTasks[0]);
+    }
+    
+    // Mono voices are added to monoOutput, which goes to both channels; stereo voices are added to each channel.
+    //  A voice adds the samples it rendered before it stopped, multiplied by its envelope
+    std::fill(monoOutput.samples, monoOutput.samples + sampleCount, 0.0f);
+    std::fill(leftOnlyOutput.samples, leftOnlyOutput.samples + sampleCount, 0.0f);
+    std::fill(rightOnlyOutput.samples, rightOnlyOutput.samples + sampleCount, 0.0f);
+    
+    for (int n = 0; n < playingVoicesCount; ++n) {
+        const int v = playingVoices[n];
+        const int voiceSamples = voiceSegmentSamples[v];
+        
+        if (voiceSamples == 0) {
+            continue;
+        }
+        
+        if (voices[v].isStereo()) {
+            kernels->addMultiplied(leftOnlyOutput.samples, voiceOutputs[v].samples, envelopes[v].samples, voiceSamples);
+            kernels->addMultiplied(rightOnlyOutput.samples, voiceRightOutputs[v].samples, envelopes[v].samples, voiceSamples);
+        }
+        else {
+            kernels->addMultiplied(monoOutput.samples, voiceOutputs[v].samples, envelopes[v].samples, voiceSamples);
+        }
+    }
+    
+    // Apply output level as a linear ramp over the segment, from its current value to where the smoother gets to
+    const float startLevel = outputLevelSmoother.getCurrentValue();
+    const float endLevel = outputLevelSmoother.skip(sampleCount);
+    const float levelStep = (endLevel - startLevel) / static_cast<float>(sampleCount);
+    
+    for (int i = 0; i < sampleCount; ++i) {
+        float outputLevel = startLevel + levelStep * static_cast<float>(i + 1);
+        float outputLeft = (monoOutput.samples[i] + leftOnlyOutput.samples[i]) * outputLevel;
+        float outputRight = (monoOutput.samples[i] + rightOnlyOutput.samples[i]) * outputLevel;
 
         // Write value in left and right buffers
         if (outputBufferRight != nullptr) {
-            outputBufferLeft[sample] = outputLeft;
-            outputBufferRight[sample] = outputRight;
+            outputBufferLeft[i] = outputLeft;
+            outputBufferRight[i] = outputRight;
         }
         else {
             // Mix both output in left buffer if mono
-            outputBufferLeft[sample] = (outputLeft + outputRight) * 0.5f;
+            outputBufferLeft[i] = (outputLeft + outputRight) * 0.5f;
         }
     }
+}
+
+int Synth::prepareRenderTasks()
+{
+    renderTasksCount = 0;
+    const int threadsCount = getRenderThreadsCount();
     
-    // Reset envelope and filter if done
-    for (int v = 0; v < constants::MAX_VOICES; ++v) {
-        Voice& voice = voices[v];
+    if (playingVoicesCount == 0) {
+        return 1;
+    }
+    
+    if (threadsCount == 1) {
+        renderTasks[renderTasksCount++] = { 0, playingVoicesCount, 0, constants::VOICE_SLOTS };
+        return 1;
+    }
+    
+    // The playing voices are in increasing order, so the voices of a group of slots follow each other. A task takes
+    //  whole groups until the tasks so far have their share of the voices; getPolyphonyVoice() spreads the notes over
+    //  the groups, so there is a group to cut at near every share
+    constexpr int groupSlots { constants::RENDER_TASK_SLOTS };
+    jassert(kernels->width <= groupSlots);
+    int n = 0;
+    
+    while (n < playingVoicesCount) {
+        RenderTask& task = renderTasks[renderTasksCount++];
+        const int sharesEnd = (playingVoicesCount * renderTasksCount + threadsCount - 1) / threadsCount;
+        task.firstVoice = n;
+        task.firstSlot = playingVoices[n] / groupSlots * groupSlots;
+        
+        do {
+            task.endSlot = playingVoices[n] / groupSlots * groupSlots + groupSlots;
+            
+            while (n < playingVoicesCount && playingVoices[n] < task.endSlot) {
+                ++n;
+            }
+        } while (n < sharesEnd);
+        
+        task.endVoice = n;
+    }
+    
+    return std::min(threadsCount, renderTasksCount);
+}
+
+void Synth::renderVoices(const RenderTask& task)
+{
+    for (int c = 0; c < segmentChunksCount; ++c) {
+        const Chunk& chunk = segmentChunks[c];
         
-        if (!voice.env.isActive()) {
-            voice.env.reset();
-            voice.lpf.reset();
-            voice.hpf.reset();
+        // Apply the LFO's modulations to the voices, at the chunk where it was updated
+        if (chunk.updatesLFO) {
+            for (int n = task.firstVoice; n < task.endVoice; ++n) {
+                Voice& voice = voices[playingVoices[n]];
+                
+                if (voice.env.isActive()) {
+                    voice.lpfMod = chunk.lpfMod;
+                    voice.hpfMod = chunk.hpfMod;
+                    voice.updateLFO();
+                    voice.modFrequency(pitchBend, chunk.vibratoMod, osc2detune);
+                }
+            }
         }
+        
+        renderChunk(task, chunk);
     }
+}
 
-    // Protect buffers from loudness
-//    loudnessProtectBuffer(outputBufferLeft, sampleCount);
-//    loudnessProtectBuffer(outputBufferRight, sampleCount);
+void Synth::renderChunk(const RenderTask& task, const Chunk& chunk)
+{
+    const int offset = chunk.offset;
+    const int sampleCount = chunk.sampleCount;
+    const float* noise = chunk.noiseOn ? segmentNoise.samples + offset : nullptr;
+    
+    // The oscillators (with their unison copies), envelopes and filters of all the active voices of the task are
+    //  rendered together, in the SIMD lanes of the kernels; only the oscillators of the PolyBLEP engine are rendered
+    //  by their voice. Stages that add nothing (silent oscillators, noise, open filters) are left out
+    constexpr int voiceOscOutputsSize { 2 * constants::MAX_UNISON * SimdKernels::oscOutputsStride };
+    constexpr int voiceOversampledOutputsSize { constants::MAX_FM_OVERSAMPLING * voiceOscOutputsSize };
+    std::array<int, constants::MAX_VOICES> activeVoices;
+    std::array<bool, constants::MAX_VOICES> phaseModulated;
+    int activeVoicesCount = 0;
+    int oscLanesCount = 0;
+    int modulationLanesCount = 0;
+    
+    // The voices of the task have no slot below its first, so their lanes fit from there
+    WavetableOscillator::Lane* taskOscLanes = &oscLanes[task.firstSlot * 2 * constants::MAX_UNISON];
+    WavetableOscillator::Lane* taskModulatorLanes = &modulatorLanes[task.firstSlot * constants::MAX_UNISON];
+    WavetableOscillator::Lane* taskCarrierLanes = &carrierLanes[task.firstSlot * constants::MAX_UNISON];
+    
+    for (int p = task.firstVoice; p < task.endVoice; ++p) {
+        const int v = playingVoices[p];
+        Voice& voice = voices[v];
+        
+        if (voice.env.isActive()) {
+            const int n = activeVoicesCount++;
+            float* oscOutput = &oscOutputs[v * voiceOscOutputsSize];
+            activeVoices[n] = v;
+            phaseModulated[n] = voice.usesPhaseModulation();
+            
+            if (phaseModulated[n]) {
+                modulationLanesCount += voice.addPhaseModulationLanes(&taskModulatorLanes[modulationLanesCount],
+                                                                      &taskCarrierLanes[modulationLanesCount],
+                                                                      &oversampledOscOutputs[v * voiceOversampledOutputsSize],
+                                                                      oscOutput, interpolationMode);
+            }
+            else {
+                oscLanesCount += voice.addOscillatorLanes(&taskOscLanes[oscLanesCount], oscOutput);
+                voice.renderSyncedOscillators(oscOutput, sampleCount, interpolationMode);
+                voice.renderPolyBlepOscillators(oscOutput, sampleCount);
+                voice.renderAdditiveOscillators(*kernels, oscOutput, sampleCount);
+                voice.skipSilentOscillators(sampleCount);
+            }
+        }
+    }
+    
+    // The envelopes are rendered up to the last playing voice of the task; the inactive ones stay as they are
+    const int envelopesEndSlot = task.endVoice > task.firstVoice ? playingVoices[task.endVoice - 1] + 1 : task.firstSlot;
+    kernels->renderOscillators(taskOscLanes, oscLanesCount, sampleCount, interpolationMode);
+    kernels->renderEnvelopes(voiceStates.env, task.firstSlot, envelopesEndSlot, envelopes.front().samples + offset,
+                             constants::MAX_SEGMENT_SAMPLES, sampleCount);
+    
+    for (int l = 0; l < oscLanesCount; ++l) {
+        taskOscLanes[l].oscillator->finishLane(taskOscLanes[l]);
+    }
+    
+    // With phase modulation, each chunk of OSC2 is rendered before the chunk of OSC1 it modulates; at the
+    //  oversampled rate, the lanes go through fmOversampling chunks of sampleCount samples, then are decimated
+    //  by their voice. Without phase modulation, none of this runs
+    if (modulationLanesCount > 0) {
+        for (int s = 0; s < fmOversampling; ++s) {
+            kernels->renderOscillators(taskModulatorLanes, modulationLanesCount, sampleCount, interpolationMode);
+            kernels->renderModulatedOscillators(taskCarrierLanes, modulationLanesCount, sampleCount, interpolationMode);
+            
+            for (int l = 0; l < modulationLanesCount; ++l) {
+                taskModulatorLanes[l].output += sampleCount;
+                taskCarrierLanes[l].output += sampleCount;
+                taskCarrierLanes[l].phaseModulation += sampleCount;
+            }
+        }
+        
+        for (int l = 0; l < modulationLanesCount; ++l) {
+            taskModulatorLanes[l].oscillator->finishLane(taskModulatorLanes[l]);
+            taskCarrierLanes[l].oscillator->finishLane(taskCarrierLanes[l]);
+        }
+        
+        for (int n = 0; n < activeVoicesCount; ++n) {
+            const int v = activeVoices[n];
+            
+            if (phaseModulated[n]) {
+                voices[v].decimatePhaseModulation(*kernels, &oversampledOscOutputs[v * voiceOversampledOutputsSize],
+                                                  &oscOutputs[v * voiceOscOutputsSize], sampleCount);
+            }
+        }
+    }
+    
+    // The voices stop with their envelope; each one mixes its oscillators and noise for its filters (in two
+    //  channels when the unison copies are spread)
+    for (int n = 0; n < activeVoicesCount; ++n) {
+        const int v = activeVoices[n];
+        Voice& voice = voices[v];
+        const int activeSamples = voice.env.getActiveSamples();
+        
+        float* output = voiceOutputs[v].samples + offset;
+        float* rightOutput = voiceRightOutputs[v].samples + offset;
+        
+        voice.mixOscillators(*kernels, output, rightOutput, activeSamples, envelopes[v].samples + offset, noise,
+                             &oscOutputs[v * voiceOscOutputsSize]);
+        voice.prepareLowPassBlock(output, rightOutput, activeSamples);
+    }
+    
+    // The filters are in series, so the high-pass filters only get their input once the low-pass filters are done;
+    //  the right channel's slots follow the left channel's
+    kernels->renderFilters(voiceStates.lpf, task.firstSlot, task.endSlot);
+    kernels->renderFilters(voiceStates.lpf, constants::VOICE_SLOTS + task.firstSlot, constants::VOICE_SLOTS + task.endSlot);
+    
+    for (int n = 0; n < activeVoicesCount; ++n) {
+        const int v = activeVoices[n];
+        const int activeSamples = voices[v].env.getActiveSamples();
+        float* output = voiceOutputs[v].samples + offset;
+        float* rightOutput = voiceRightOutputs[v].samples + offset;
+        
+        voices[v].finishLowPassBlock(output, rightOutput, activeSamples);
+        voices[v].prepareHighPassBlock(output, rightOutput, activeSamples);
+    }
+    
+    kernels->renderFilters(voiceStates.hpf, task.firstSlot, task.endSlot);
+    kernels->renderFilters(voiceStates.hpf, constants::VOICE_SLOTS + task.firstSlot, constants::VOICE_SLOTS + task.endSlot);
+    
+    for (int n = 0; n < activeVoicesCount; ++n) {
+        const int v = activeVoices[n];
+        const int activeSamples = voices[v].env.getActiveSamples();
+        
+        voices[v].finishHighPassBlock(voiceOutputs[v].samples + offset, voiceRightOutputs[v].samples + offset, activeSamples);
+        voiceSegmentSamples[v] = offset + activeSamples;
+    }
 }
 
 void Synth::midiMessage(uint8_t data0, uint8_t data1, uint8_t data2)
@@ -206,14 +561,62 @@ void Synth::midiMessage(uint8_t data0, uint8_t data1, uint8_t data2)
     }
 }
 
-void Synth::startVoice(int voiceIndex, int note, int velocity)
+void Synth::adoptEngineState(EngineState* newState)
 {
+    for (Voice& voice : voices) {
+        voice.applyEngineState(*newState);
+        
+        // Playing notes need their increments calculated again for the new sample rate
+        if (voice.env.isActive()) {
+            updateFreq(voice);
+        }
+    }
+    
+    // The previous state is freed later, away from the audio thread
+    engineStateBuilder.retire(engineState);
+    engineState = newState;
+}
+
+void Synth::applyOscillatorSettings(Voice& voice, const float* partialGains)
+{
+    // Update some voice toggles
+    voice.ringMod = ringMod;
+    voice.phaseRand = phaseRand;
+    
+    // Update OSC settings
+    voice.osc1Morph = osc1Morph;
+    voice.osc2Morph = osc2Morph;
+    voice.osc1Level = osc1Level;
+    voice.osc2Level = osc2Level;
+    voice.osc1Engine = osc1Engine;
+    voice.osc2Engine = osc2Engine;
+    
+    // Unison
+    voice.unison = unison;
+    voice.unisonDetune = unisonDetune;
+    voice.unisonSpread = unisonSpread;
+    
+    // Phase modulation
+    voice.fmAmount = fmAmount;
+    voice.fmOversampling = fmOversampling;
+    voice.hardSync = hardSync;
+    
+    // Additive engine
+    voice.additivePartials = additivePartials;
+    voice.additiveGains = partialGains;
+}
+
+void Synth::startVoice(int place, int note, int velocity)
+{
+    const int voiceIndex = getPolyphonyVoice(place, getRenderThreadsCount());
     Voice& voice = voices[voiceIndex];
+    applyOscillatorSettings(voice, updateAdditiveGains());
+    addPlayingVoice(voiceIndex);
 
     // Get frequency for note from MIDI number
-    const auto freq = midiNoteNumberToFreq(note, voiceIndex);
+    const auto freq = midiNoteNumberToFreq(note, place);
     
-    voice.setFrequencyAtNote(note, freq);
+    voice.setFrequency(freq);
 
 //    voice.target = freq;
     
@@ -245,9 +648,10 @@ void Synth::startVoice(int voiceIndex, int note, int velocity)
     float velocityCurve = 0.004f * float((velocity + 64) * (velocity + 64)) - 8.0f;
     voice.velocityAmp = velocityCurve * volumeTrim;
         
-    // OSC levels
+    // OSC levels; the note starts right at them
     voice.osc1Level = osc1Level;
     voice.osc2Level = osc2Level;
+    voice.snapLevels();
 
     // LRN & to dereference voice.env to access it just by env variable
     // Envelope settings + trigger envelope
@@ -287,17 +691,17 @@ void Synth::noteOn(int note, int velocity)
         velocity = 80;
     }
     
-    int v = 0; // Voice index
+    int place = 0; // Place of the voice in the polyphony
     
     if (polyMode == 0) { // Mono
         addHeldNote(note);
     }
     else { // Poly
         emptyHeldNotes(); // clear mono held notes to prevent issues
-        v = findFreeVoice();
+        place = findFreeVoice();
     }
     
-    startVoice(v, note, velocity);
+    startVoice(place, note, velocity);
 }
 
 void Synth::noteOff(int note)
@@ -316,13 +720,15 @@ void Synth::noteOff(int note)
         emptyHeldNotes(); // clear mono held notes to prevent issues
     }
     
-    for (int v = 0; v < constants::MAX_VOICES; ++v) {
-        if (voices[v].note == note) {
+    for (int n = 0; n < playingVoicesCount; ++n) {
+        Voice& voice = voices[playingVoices[n]];
+        
+        if (voice.note == note) {
             if (!sustainPressed) {
-                voices[v].release();
+                voice.release();
             }
             else {
-                voices[v].sustained = true;
+                voice.sustained = true;
             }
         }
     }
@@ -330,18 +736,41 @@ void Synth::noteOff(int note)
 
 int Synth::findFreeVoice() const
 {
-    int v = 0;
+    int place = 0;
     float l = 100.0f; // Arbitrarily loud level
+    const int polyphony = std::clamp(maxPolyphony, 1, constants::MAX_VOICES);
+    const int threadsCount = getRenderThreadsCount();
     
     // Find quietest voice that is not in attack stage
-    for (int i = 0; i < constants::MAX_VOICES; ++i) {
-        if (voices[i].env.level < l && !voices[i].env.isInAttack()) {
-            l = voices[i].env.level;
-            v = i;
+    for (int i = 0; i < polyphony; ++i) {
+        const Voice& voice = voices[getPolyphonyVoice(i, threadsCount)];
+        
+        if (voice.env.getLevel() < l && !voice.env.isInAttack()) {
+            l = voice.env.getLevel();
+            place = i;
         }
     }
     
-    return v;
+    return place;
+}
+
+int Synth::getPolyphonyVoice(int i, int threadsCount) const
+{
+    if (threadsCount == 1) {
+        return i;
+    }
+    
+    // Every group holds RENDER_TASK_SLOTS voices, so there are enough of them for the polyphony
+    constexpr int groupSlots { constants::RENDER_TASK_SLOTS };
+    const int polyphony = std::clamp(maxPolyphony, 1, constants::MAX_VOICES);
+    const int groupsCount = std::clamp(threadsCount, (polyphony + groupSlots - 1) / groupSlots, constants::MAX_VOICES / groupSlots);
+    
+    return i % groupsCount * groupSlots + i / groupsCount;
+}
+
+int Synth::getRenderThreadsCount() const
+{
+    return std::clamp(renderThreads, 1, workerPool->getWorkersCount() + 1);
 }
 
 void Synth::controlChange(uint8_t data1, uint8_t data2)
@@ -358,10 +787,12 @@ void Synth::controlChange(uint8_t data1, uint8_t data2)
             
             // Sustain pedal is lifted
             if (!sustainPressed) {
-                for (int v = 0; v < constants::MAX_VOICES; ++v) {
-                    if (voices[v].sustained) {
-                        voices[v].release();
-                        voices[v].sustained = false;
+                for (int n = 0; n < playingVoicesCount; ++n) {
+                    Voice& voice = voices[playingVoices[n]];
+                    
+                    if (voice.sustained) {
+                        voice.release();
+                        voice.sustained = false;
                     }
                 }
                 emptyHeldNotes();
@@ -372,9 +803,10 @@ void Synth::controlChange(uint8_t data1, uint8_t data2)
             // Anything with control ID >= 120 is treated as a PANIC command
             // Kill all voices and lift sustain
             if (data1 >= 0x78) {
-                for (int v = 0; v < constants::MAX_VOICES; ++v) {
-                    voices[v].reset();
+                for (Voice& voice : voices) {
+                    voice.reset();
                 }
+                playingVoicesCount = 0;
                 sustainPressed = false;
             }
             break;
@@ -382,64 +814,139 @@ void Synth::controlChange(uint8_t data1, uint8_t data2)
     }
 }
 
-void Synth::updateLFO()
+const float* Synth::updateAdditiveGains()
 {
-    // Decrement and enter every LOWER_UPDATE_RATE_MAX_VALUE step
-    if (--lfoStep <= 0) {
-        lfoStep = constants::LOWER_UPDATE_RATE_MAX_VALUE;
-        
-        lfo += lfoInc;
-        
-        // Keep lfo phase value between -/+ pi for std:sin()
-        if (lfo > constants::PI) { lfo -= constants::TWO_PI; }
+    if (additiveTilt == 0.0f) {
+        return nullptr;
+    }
+    
+    // Partial n is log2(n) octaves above the fundamental, so its gain in dB is the tilt times log2(n): the gain is
+    //  n^exponent. The gain of n = a * b is then the gain of a times the gain of b, so only the primes (54 of the 256
+    //  partials) take a power; this runs on the audio thread with every change of the tilt
+    if (additiveTilt != cachedAdditiveTilt) {
+        const float exponent = additiveTilt / (20.0f * std::log10(2.0f));
+        additiveGains[0] = 1.0f;
         
-        const float sine = std::sin(lfo);
+        for (int n = 2; n <= constants::MAX_PARTIALS; ++n) {
+            const int factor = partialNumbers.smallestFactors[n];
+            
+            additiveGains[n - 1] = factor == n ? std::exp2(exponent * partialNumbers.octaves[n])
+                                               : additiveGains[factor - 1] * additiveGains[n / factor - 1];
+        }
         
-        // Create and apply vibrato modulation to voices
-        vibratoMod = 1.0f + sine * (modWheel + vibrato);
+        cachedAdditiveTilt = additiveTilt;
+    }
+    
+    return additiveGains.data();
+}
+
+void Synth::updateLFO()
+{
+    lfo += lfoInc;
+    
+    // Keep lfo phase value between -/+ pi for std:sin()
+    if (lfo > constants::PI) { lfo -= constants::TWO_PI; }
+    
+    const float sine = std::sin(lfo);
+    
+    // Create and apply vibrato modulation to voices
+    vibratoMod = 1.0f + sine * (modWheel + vibrato);
+    
+    // LFO depth for filter cutoff
+    float lpfMod = lpfLFODepth * sine;
+    float hpfMod = hpfLFODepth * sine;
+    
+    // One-pole filter to move filterZip closer to filterMod every step
+    lpfZip += 0.005f * (lpfMod - lpfZip);
+    hpfZip += 0.005f * (hpfMod - hpfZip);
+}
+
+void Synth::updatePolyphony()
+{
+    const int polyphony = std::clamp(maxPolyphony, 1, constants::MAX_VOICES);
+    const int threadsCount = getRenderThreadsCount();
+    std::array<bool, constants::MAX_VOICES> usable {};
+    
+    for (int i = 0; i < polyphony; ++i) {
+        usable[getPolyphonyVoice(i, threadsCount)] = true;
+    }
+    
+    // The voices notes may no longer use get no new notes; they are released, and stop once their envelope is done
+    for (int n = 0; n < playingVoicesCount; ++n) {
+        if (!usable[playingVoices[n]]) {
+            voices[playingVoices[n]].release();
+        }
+    }
+}
+
+void Synth::addPlayingVoice(int voiceIndex)
+{
+    // The list stays in increasing order, so the voices are always mixed in the same order
+    int n = playingVoicesCount;
+    
+    while (n > 0 && playingVoices[n - 1] >= voiceIndex) {
+        if (playingVoices[n - 1] == voiceIndex) {
+            return;
+        }
+        --n;
+    }
+    
+    for (int m = playingVoicesCount; m > n; --m) {
+        playingVoices[m] = playingVoices[m - 1];
+    }
+    
+    playingVoices[n] = voiceIndex;
+    ++playingVoicesCount;
+}
+
+void Synth::retireVoices()
+{
+    int kept = 0;
+    
+    for (int n = 0; n < playingVoicesCount; ++n) {
+        Voice& voice = voices[playingVoices[n]];
         
-        // LFO depth for filter cutoff
-        float lpfMod = lpfLFODepth * sine;
-        float hpfMod = hpfLFODepth * sine;
+        if (voice.env.isActive()) {
+            playingVoices[kept++] = playingVoices[n];
+            continue;
+        }
         
-        // One-pole filter to move filterZip closer to filterMod every step
-        lpfZip += 0.005f * (lpfMod - lpfZip);
-        hpfZip += 0.005f * (hpfMod - hpfZip);
+        voice.env.reset();
+        voice.lpf.reset();
+        voice.hpf.reset();
+        voice.lpfRight.reset();
+        voice.hpfRight.reset();
         
-        for (int v = 0; v < constants::MAX_VOICES; ++v) {
-            Voice& voice = voices[v];
-            
-            if (voice.env.isActive()) {
-                voice.lpfMod = lpfZip;
-                voice.hpfMod = hpfZip;
-                voice.updateLFO();
-                updateFreq(voice);
-            }
-        }
+        // A voice that stopped while the sustain pedal was down has nothing left to release
+        voice.sustained = false;
     }
+    
+    playingVoicesCount = kept;
 }
 
 void Synth::updateFreq(Voice &voice)
 {
-    voice.modFrequencyAtNote(voice.note, pitchBend, vibratoMod, osc2detune);
+    voice.modFrequency(pitchBend, vibratoMod, osc2detune);
 }
 
-float Synth::midiNoteNumberToFreq(int midiNoteNumber, int voiceIndex)
+float Synth::midiNoteNumberToFreq(int midiNoteNumber, int place)
 {
-    // Also apply general synth tuning
-    return 440.0f * std::exp2((float(midiNoteNumber - 69 + (constants::ANALOG_DRIFT * float(voiceIndex))) + tune) / 12.0f);
+    // Also apply general synth tuning; the drift repeats every DEFAULT_POLYPHONY voices, so the last voices of a
+    //  large polyphony are not out of tune
+    const int driftIndex = place % constants::DEFAULT_POLYPHONY;
+    return 440.0f * std::exp2((float(midiNoteNumber - 69 + (constants::ANALOG_DRIFT * float(driftIndex))) + tune) / 12.0f);
 }
 
 void Synth::emptyHeldNotes()
 {
-    for (int i = 0; i < constants::MAX_VOICES; ++i) {
+    for (int i = 0; i < constants::MIDI_NOTES_COUNT; ++i) {
         heldNotesMono[i] = constants::NO_NOTE_VALUE;
     }
 }
 
 void Synth::addHeldNote(int note)
 {
-    for (int i = 0; i < constants::MAX_VOICES; ++i) {
+    for (int i = 0; i < constants::MIDI_NOTES_COUNT; ++i) {
         if (heldNotesMono[i] == constants::NO_NOTE_VALUE) {
             heldNotesMono[i] = note;
             break;
@@ -450,7 +957,7 @@ void Synth::addHeldNote(int note)
 void Synth::removeHeldNote(int note)
 {
     int i;
-    for (i = 0; i < constants::MAX_VOICES; ++i) {
+    for (i = 0; i < constants::MIDI_NOTES_COUNT; ++i) {
         if (heldNotesMono[i] == note) {
             heldNotesMono[i] = constants::NO_NOTE_VALUE;
             break;
@@ -458,9 +965,9 @@ void Synth::removeHeldNote(int note)
     }
     
     // Shift remaining held notes down 1 position
-    for (i = i + 1; i < constants::MAX_VOICES; ++i) {
+    for (i = i + 1; i < constants::MIDI_NOTES_COUNT; ++i) {
         heldNotesMono[i - 1] = heldNotesMono[i];
-        if (i == constants::MAX_VOICES - 1) {
+        if (i == constants::MIDI_NOTES_COUNT - 1) {
             heldNotesMono[i] = 0;
         }
     }
@@ -470,7 +977,7 @@ int Synth::lastHeldNote()
 {
     int last = constants::NO_NOTE_VALUE;
     
-    for (int i = 0; i < constants::MAX_VOICES; ++i) {
+    for (int i = 0; i < constants::MIDI_NOTES_COUNT; ++i) {
         if (heldNotesMono[i] != constants::NO_NOTE_VALUE) {
             last = heldNotesMono[i];
         }
@@ -480,7 +987,7 @@ int Synth::lastHeldNote()
 }
 
 bool Synth::heldNotesEmpty() {
-    for (int i = 0; i < constants::MAX_VOICES; ++i) {
+    for (int i = 0; i < constants::MIDI_NOTES_COUNT; ++i) {
         if (heldNotesMono[i] != constants::NO_NOTE_VALUE) { return false; }
     }
 
@@ -15,6 +15,7 @@
 #include <JuceHeader.h>
 #include <stack>
 #include "Constants.h"
+#include "RealtimeWorkerPool.h"
 #include "Voice.h"
 #include "WhiteNoise.h"
 #include "PinkNoise.h"
@@ -30,12 +31,22 @@ public:
     float tune; // synth's cents tuning
     float osc2detune; // overall tuning of OSC2 (semitones + cents)
     float osc1Morph, osc2Morph; // OSC1&2 shape
+    oscillatorEngine::Engine osc1Engine = oscillatorEngine::wavetable; // OSC1 engine
+    oscillatorEngine::Engine osc2Engine = oscillatorEngine::wavetable; // OSC2 engine
     float volumeTrim; // master output level trim
     float velocitySensitivity; // velocity sensitivity multiplier
     float lfoInc; // phase increment for LFO (between 0 and 2pi)
     float vibrato; // pitch LFO depth
     float modWheel; // modulation wheel value
     float vibratoMod; // vibrato modulation valye
+    int unison = 1; // copies of each oscillator in every voice
+    float unisonDetune = 0.0f; // detune of the outermost unison copies, in cents
+    float unisonSpread = 0.0f; // stereo width of the unison copies, from 0 to 1
+    float fmAmount = 0.0f; // phase modulation of OSC1 by OSC2, from 0 to 1
+    int fmOversampling = 1; // oversampling factor of the phase modulation (1, 2 or 4)
+    bool hardSync = false; // OSC2 restarts with every period of OSC1
+    int additivePartials = constants::MAX_PARTIALS; // most partials of the additive engine
+    float additiveTilt = 0.0f; // gain of the partials of the additive engine over the fundamental, in dB per octave
 //    float glideRate; // speed of glide
 //    float glideBend; // adds a glide up or down before new notes
     // LPF values
@@ -49,20 +60,33 @@ public:
     float hpfAttack, hpfDecay, hpfSustain, hpfRelease;
     float hpfEnvDepth;
     int polyMode; // 0: Mono; 1: Poly;
+    int maxPolyphony = constants::DEFAULT_POLYPHONY; // most voices playing at once in poly mode, 1 to constants::MAX_VOICES
+    int renderThreads = 1; // threads rendering the voices, 1 (the audio thread only) to constants::MAX_RENDER_THREADS
 //    int glideMode;
     int noiseType; // 0: White; 1: Pink
     bool ignoreVelocity; // velocity toggle
     bool ringMod; // ring mod toggle
     bool phaseRand; // phase randomizer toggle
+    interpolation::Mode interpolationMode = interpolation::linear; // quality of the oscillators for the current render mode
     juce::LinearSmoothedValue<float> outputLevelSmoother; // smoother for output level
     
     Synth();
+    ~Synth();
     
     /**
-     Allocates memory for audio rendering.
+     Allocates memory for audio rendering. The first call creates every voice (constants::MAX_VOICES of them, so
+     maxPolyphony changes without allocating) with its oscillators; later calls (new sample rate) never block, the new
+     wavetables being prepared in the background and swapped in by render(). The workers of multi-core mode spin
+     for a block period between the blocks.
      */
     void allocateResources(double sampleRate, int samplesPerBlock);
     
+    /**
+     Starts the workers shared by every synth instance if renderThreads is more than 1, so they only exist once an
+     instance asks for them; until then, the voices are rendered on the audio thread. Not called on the audio thread.
+     */
+    void prepareRenderThreads(int renderThreads);
+    
     /**
      Deallocate memory after usage finished.
      */
@@ -114,17 +138,16 @@ public:
     bool heldNotesEmpty();
 
 private:
-    int lfoStep; // counter from LFO max value to 0
+    int lfoStep; // samples left before the next LFO update
 //    int lastNote; // keep track of last note for glide
     int lastVelocity; // keep track of the velocity of the last held note
     /**
-     The list of held notes in mono mode is represented as a list of 10 integers.
+     The list of held notes in mono mode is represented as a list of integers, one per MIDI note, so every key
+     can be held at once.
      The constant for no notes means no note is held, and any other number means the note is held.
      The last held note is the last number in the list that != the no note value constant
-     Even though last note priority is a mono mode feature and only one voice is used,
-     we still use the max voices constant, since 10 held notes is enough.
      */
-    int heldNotesMono[constants::MAX_VOICES];
+    int heldNotesMono[constants::MIDI_NOTES_COUNT];
     float sampleRate; // sample rate taken from host
     float pitchBend; // pitch bend value
     float lfo; // current phase of LFO sine wave
@@ -132,10 +155,85 @@ private:
     float lpfZip;
     float hpfZip;
     bool sustainPressed; // sustain pressed toggle
-    // LRN allocate arr size directly in std::array<Type, Size> arr;
-    std::array<Voice, constants::MAX_VOICES> voices; // voices array
+    std::vector<Voice> voices; // every voice, created by allocateResources
+    VoiceStates voiceStates; // envelopes and filters of the voices, one slot per voice
+    // Indexes of the playing voices, in increasing order: a voice joins the list when it starts a note, and leaves it
+    //  at the end of the render where its envelope is done, so idle voices cost nothing
+    std::array<int, constants::MAX_VOICES> playingVoices;
+    int playingVoicesCount = 0;
+    EngineStateBuilder engineStateBuilder; // prepares engine states for new sample rates
+    EngineState* engineState = nullptr; // state used by the audio thread, owned by it
+    bool oscillatorsAllocated = false; // true once the voices' oscillators exist
+    const SimdKernels* kernels = nullptr; // hot loops, compiled for the best instruction set of the processor
+    // Renders voices alongside the audio thread with renderThreads > 1; the process has a single pool, shared by
+    //  every synth instance, so its threads are started once (by the first instance asking for them) whatever the
+    //  number of instances
+    juce::SharedResourcePointer<RealtimeWorkerPool> workerPool;
+    
+    // Working buffers of a chunk, for every voice playing at once; they are allocated with the voices. Every voice
+    //  uses its own part of them (given by its index, or by the first slot of its task for the lanes), so the tasks
+    //  of multi-core mode never share one
+    // Lanes and outputs of the oscillators, with every unison copy
+    std::vector<WavetableOscillator::Lane> oscLanes;
+    std::vector<float> oscOutputs;
+    // Oscillators of the voices where OSC2 modulates the phase of OSC1, rendered at the oversampled rate
+    std::vector<WavetableOscillator::Lane> modulatorLanes;
+    std::vector<WavetableOscillator::Lane> carrierLanes;
+    std::vector<float> oversampledOscOutputs;
+    
+    // A segment of a voice, aligned for the SIMD kernels
+    struct alignas(64) SegmentBuffer
+    {
+        float samples[constants::MAX_SEGMENT_SAMPLES];
+    };
+    
+    // Every voice renders a whole segment in its own buffers, chunk by chunk, before the voices are mixed down; the
+    //  buffers are indexed by voice, and are allocated with the voices
+    std::vector<SegmentBuffer> envelopes; // envelope of every voice slot
+    std::vector<SegmentBuffer> voiceOutputs; // output of every voice (left channel of a stereo voice)
+    std::vector<SegmentBuffer> voiceRightOutputs; // right channel of every stereo voice
+    alignas(64) std::array<int, constants::MAX_VOICES> voiceSegmentSamples; // samples every voice rendered before it stopped
+    // Sum of the voices of a segment: mono voices (for both channels), and stereo voices in each channel
+    SegmentBuffer monoOutput;
+    SegmentBuffer leftOnlyOutput;
+    SegmentBuffer rightOnlyOutput;
+    
+    // A chunk of the segment, with the modulations of the LFO for it; the LFO and the noise are shared by every
+    //  voice, so they are rendered for the whole segment before the voices
+    struct Chunk
+    {
+        int offset; // first sample in the segment
+        int sampleCount;
+        bool updatesLFO; // the LFO is updated at the start of the chunk
+        bool noiseOn; // noise is generated (in segmentNoise), else it is off and none is mixed
+        float vibratoMod;
+        float lpfMod;
+        float hpfMod;
+    };
+    
+    std::array<Chunk, constants::MAX_SEGMENT_SAMPLES / constants::LOWER_UPDATE_RATE_MAX_VALUE + 1> segmentChunks;
+    int segmentChunksCount = 0;
+    SegmentBuffer segmentNoise;
+    
+    // Voices rendered together, by one thread: a range of the playing voices, all in whole groups of
+    //  RENDER_TASK_SLOTS slots, so the task shares no vector of the kernels nor cache line of the voices' states
+    //  with the other tasks
+    struct RenderTask
+    {
+        int firstVoice; // first index in playingVoices
+        int endVoice;
+        int firstSlot;
+        int endSlot;
+    };
+    
+    std::array<RenderTask, constants::VOICE_SLOTS / constants::RENDER_TASK_SLOTS> renderTasks;
+    int renderTasksCount = 0;
+    // Gain of every partial of the additive engine for the tilt it was calculated for
+    std::array<float, constants::MAX_PARTIALS> additiveGains {};
+    float cachedAdditiveTilt = 0.0f;
     WhiteNoise whiteNoise;
     PinkNoise pinkNoise;
+    juce::LinearSmoothedValue<float> noiseLevelSmoother; // ramps the noise level, so the noise goes on and off without clicks
     
     /**
      Handles the Note On command.
@@ -148,20 +246,91 @@ private:
     void noteOff(int note);
         
     /**
-     Starts a voice.
+     Switches the voices to a new engine state, and retires the previous one. Called on the audio thread.
      */
-    void startVoice(int voiceIndex, int note, int velocity);
+    void adoptEngineState(EngineState* newState);
+    
+    /**
+     Starts the voice at a place of the polyphony (see getPolyphonyVoice()); place 0 is the voice of mono mode.
+     */
+    void startVoice(int place, int note, int velocity);
+    
+    /**
+     Gives a voice the synth's current settings of the oscillators.
+     */
+    void applyOscillatorSettings(Voice& voice, const float* partialGains);
+    
+    /**
+     Adds a voice to the playing voices, if it is not playing already.
+     */
+    void addPlayingVoice(int voiceIndex);
+    
+    /**
+     Resets the voices whose envelope is done and takes them out of the playing voices. Called at the end of render().
+     */
+    void retireVoices();
         
     /**
-     Finds a free voice to use for the next note played when all voices are in use. This will be the 
-     quietest voice that is not in the attack stage. The index of the voice is returned.
+     Finds a free voice to use for the next note played, among the maxPolyphony voices notes may use; when they are
+     all in use, this will be the quietest voice that is not in the attack stage. The place of the voice in the
+     polyphony is returned.
      */
     int findFreeVoice() const;
     
     /**
-     Updates the synth's LFO .
+     Returns the voice the i-th note of the polyphony may use, for i below maxPolyphony. With a single render
+     thread, these are the first voices. With more, they go round-robin over groups of RENDER_TASK_SLOTS slots (one
+     group for every thread, or more when the polyphony needs them), so the notes playing are spread over groups
+     that different threads can render.
+     */
+    int getPolyphonyVoice(int i, int threadsCount) const;
+    
+    /**
+     Returns the threads rendering the voices: renderThreads, within the workers started.
+     */
+    int getRenderThreadsCount() const;
+    
+    /**
+     Releases the voices notes may no longer use, when maxPolyphony goes down or the render threads change; they
+     stop once their envelope is done.
+     */
+    void updatePolyphony();
+    
+    /**
+     Calculates the gains of the partials of the additive engine again if its tilt changed, and returns them
+     (nullptr without tilt).
+     */
+    const float* updateAdditiveGains();
+    
+    /**
+     Updates the synth's LFO and the modulations it drives, which the voices take at their next chunk. Called
+     every LOWER_UPDATE_RATE_MAX_VALUE samples.
      */
     void updateLFO();
+    
+    /**
+     Renders a segment of at most MAX_SEGMENT_SAMPLES samples of all the voices in the output buffers: every voice
+     renders it in its own buffers (in tasks spread over renderThreads threads), then they are mixed down and the
+     output level is applied as a ramp over the segment. outputBufferRight is nullptr for mono output.
+     */
+    void renderSegment(float* outputBufferLeft, float* outputBufferRight, int sampleCount);
+    
+    /**
+     Splits the playing voices in the tasks of a segment: a single one on the audio thread, or in multi-core mode,
+     a task for every thread with an even share of the voices (in whole groups of RENDER_TASK_SLOTS slots). Returns
+     the threads rendering them.
+     */
+    int prepareRenderTasks();
+    
+    /**
+     Renders every chunk of the segment for the voices of a task. Called by the task's thread.
+     */
+    void renderVoices(const RenderTask& task);
+    
+    /**
+     Renders a chunk of at most LOWER_UPDATE_RATE_MAX_VALUE samples of the voices of a task in their buffers.
+     */
+    void renderChunk(const RenderTask& task, const Chunk& chunk);
         
     /**
      Updates the oscillators frequency if the voice changes it (while gliding or pitch bending, for example).
@@ -169,9 +338,10 @@ private:
     void updateFreq(Voice& voice);
     
     /**
-     Converts a MIDI note number to a frequency in hertz. Adds analog drift with voice index.
+     Converts a MIDI note number to a frequency in hertz. Adds analog drift with the place of the voice in the
+     polyphony, so the drift doesn't change with the render threads.
      */
-    float midiNoteNumberToFreq(int midiNoteNumber, int voiceIndex);
+    float midiNoteNumberToFreq(int midiNoteNumber, int place);
     
     /**
      Helper method to determine if synth is being played in legato style.
@@ -10,6 +10,17 @@
 
 #include "Voice.h"
 
+void Voice::bind(VoiceStates& states, int slot)
+{
+    env.bind(states.env, slot);
+    lpfEnv.bind(states.lpfEnv, slot);
+    hpfEnv.bind(states.hpfEnv, slot);
+    lpf.bind(states.lpf, slot);
+    hpf.bind(states.hpf, slot);
+    lpfRight.bind(states.lpf, constants::VOICE_SLOTS + slot);
+    hpfRight.bind(states.hpf, constants::VOICE_SLOTS + slot);
+}
+
 void Voice::reset()
 {
     note = constants::NO_NOTE_VALUE;
@@ -18,11 +29,33 @@ void Voice::reset()
     lpfEnv.reset();
     hpf.reset();
     hpfEnv.reset();
+    lpfRight.reset();
+    hpfRight.reset();
+    stereoFilters = false;
+    lpfBypass = {};
+    hpfBypass = {};
+    osc1LevelSmoother.reset(constants::RAMP_SAMPLES);
+    osc2LevelSmoother.reset(constants::RAMP_SAMPLES);
+    osc1LevelSmoother.setCurrentAndTargetValue(0.0f);
+    osc2LevelSmoother.setCurrentAndTargetValue(0.0f);
     osc1Morph = 0.f;
     osc2Morph = 0.f;
     ringMod = false;
     phaseRand = false;
     sustained = false;
+    unison = 1;
+    unisonDetune = 0.0f;
+    unisonSpread = 0.0f;
+    osc1Engine = oscillatorEngine::wavetable;
+    osc2Engine = oscillatorEngine::wavetable;
+    fmAmount = 0.0f;
+    fmOversampling = 1;
+    hardSync = false;
+    additivePartials = constants::MAX_PARTIALS;
+    additiveGains = nullptr;
+    decimationFactor = 0;
+    phaseModulating = false;
+    phaseModulationDelay = 0.0f;
 }
     
 void Voice::release()
@@ -32,66 +65,403 @@ void Voice::release()
     hpfEnv.release();
 }
 
-float Voice::render(float noise)
+bool Voice::isStereo() const
+{
+    return unison > 1 && unisonSpread > 0.0f;
+}
+
+void Voice::snapLevels()
+{
+    osc1LevelSmoother.setCurrentAndTargetValue(osc1Level);
+    osc2LevelSmoother.setCurrentAndTargetValue(osc2Level);
+}
+
+bool Voice::isOsc1Heard() const
+{
+    const bool osc1Playing = osc1Level != 0.0f || osc1LevelSmoother.getCurrentValue() != 0.0f;
+    const bool osc2Playing = osc2Level != 0.0f || osc2LevelSmoother.getCurrentValue() != 0.0f;
+    
+    return osc1Playing && (!ringMod || osc2Playing);
+}
+
+bool Voice::isOsc2Heard() const
+{
+    const bool osc1Playing = osc1Level != 0.0f || osc1LevelSmoother.getCurrentValue() != 0.0f;
+    const bool osc2Playing = osc2Level != 0.0f || osc2LevelSmoother.getCurrentValue() != 0.0f;
+    
+    return osc2Playing && (!ringMod || osc1Playing);
+}
+
+int Voice::addOscillatorLanes(WavetableOscillator::Lane* lanes, float* oscOutputs)
+{
+    int lanesCount = 0;
+    
+    // The decimation filters are filled again when the phase modulation comes back
+    decimationFactor = 0;
+    
+    // The copies play along with the note's oscillator
+    if (tableOsc1[0].isPlaying() && osc1Engine == oscillatorEngine::wavetable && isOsc1Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            WavetableOscillator& osc = tableOsc1[c];
+            osc.setMorph(osc1Morph);
+            osc.prepareLane(lanes[lanesCount++], oscOutputs + c * SimdKernels::oscOutputsStride);
+        }
+    }
+    
+    if (tableOsc2[0].isPlaying() && osc2Engine == oscillatorEngine::wavetable && !usesHardSync() && isOsc2Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            WavetableOscillator& osc = tableOsc2[c];
+            osc.setMorph(osc2Morph);
+            osc.prepareLane(lanes[lanesCount++], oscOutputs + (constants::MAX_UNISON + c) * SimdKernels::oscOutputsStride);
+        }
+    }
+    
+    return lanesCount;
+}
+
+bool Voice::usesHardSync()
+{
+    return hardSync && osc2Engine == oscillatorEngine::wavetable && tableOsc1[0].isPlaying()
+        && tableOsc2[0].isPlaying();
+}
+
+void Voice::renderSyncedOscillators(float* oscOutputs, int numSamples, interpolation::Mode mode)
 {
-    float output = 0.0f;
-    float envelope = env.nextValue();
-
-    // If the envelope is done (level extremely close to 0), stop note
-    if (envelope < constants::SILENCE_TRESHOLD) {
-        sineTableOsc1[note].stop(phaseRand);
-        sawTableOsc1[note].stop(phaseRand);
-        triTableOsc1[note].stop(phaseRand);
-        squareTableOsc1[note].stop(phaseRand);
+    if (!usesHardSync()) {
+        return;
+    }
+    
+    // The wavetable oscillators of OSC1 keep its phase whatever its engine
+    for (int c = 0; c < unison; ++c) {
+        const WavetableOscillator& master = tableOsc1[c];
+        WavetableOscillator& osc = tableOsc2[c];
+        
+        if (!isOsc2Heard()) {
+            osc.skipSyncedBlock(numSamples, master.getPhase(), master.getPhaseIncrement());
+            continue;
+        }
         
-        sineTableOsc2[note].stop(phaseRand);
-        sawTableOsc2[note].stop(phaseRand);
-        triTableOsc2[note].stop(phaseRand);
-        squareTableOsc2[note].stop(phaseRand);
+        osc.setMorph(osc2Morph);
+        osc.renderSyncedBlock(oscOutputs + (constants::MAX_UNISON + c) * SimdKernels::oscOutputsStride, numSamples,
+                              master.getPhase(), master.getPhaseIncrement(), mode);
+    }
+}
 
-        note = constants::NO_NOTE_VALUE;
+bool Voice::usesPhaseModulation()
+{
+    const bool possible = !hardSync && osc1Engine == oscillatorEngine::wavetable && osc2Engine == oscillatorEngine::wavetable
+        && tableOsc1[0].isPlaying() && tableOsc2[0].isPlaying();
+    
+    if (!possible) {
+        // The engines or the hard sync changed, which changes the sound anyway; the oscillators go back to the phase
+        //  they would have without the delay
+        if (phaseModulating) {
+            setPhaseModulationDelay(1);
+            phaseModulating = false;
+        }
     }
+    else if (!phaseModulating) {
+        phaseModulating = fmAmount > 0.0f && isOsc1Heard();
+    }
+    
+    return phaseModulating;
+}
+
+void Voice::setPhaseModulationDelay(int oversampling)
+{
+    const float delay = oversampling > 1 ? SimdKernels::decimationDelay(oversampling) : 0.0f;
     
-    // All tables are "playing" at the same time, so we only need to check on one
-    if (sineTableOsc1[note].isPlaying()) {
-        float sineSample = sineTableOsc1[note].getSample();
-        float triSample = triTableOsc1[note].getSample();
-        float squareSample = squareTableOsc1[note].getSample();
-        float sawSample = sawTableOsc1[note].getSample();
+    if (delay == phaseModulationDelay) {
+        return;
+    }
+    
+    for (size_t c = 0; c < tableOsc1.size(); ++c) {
+        tableOsc1[c].shiftPhase(delay - phaseModulationDelay);
+        tableOsc2[c].shiftPhase(delay - phaseModulationDelay);
+    }
+    
+    phaseModulationDelay = delay;
+}
+
+int Voice::addPhaseModulationLanes(WavetableOscillator::Lane* modulatorLanes, WavetableOscillator::Lane* carrierLanes,
+                                   float* oversampledOutputs, float* oscOutputs, interpolation::Mode mode)
+{
+    float* outputs = fmOversampling > 1 ? oversampledOutputs : oscOutputs;
+    const int stride = fmOversampling * SimdKernels::oscOutputsStride;
+    
+    if (decimationFactor != fmOversampling) {
+        // The decimation delays the oscillators, so they move on by as much: the samples that come out of it go on
+        //  from the ones played before. Its filters start from what the oscillators played up to their new phase
+        //  (without the modulation, which is new or barely changes what they are filled with)
+        setPhaseModulationDelay(fmOversampling);
         
-        if (ringMod) {
-            output += interpolatedSample(osc1Morph, sineSample, triSample, squareSample, sawSample) * 0.4f * osc1Level;
+        if (fmOversampling > 1) {
+            const int historyLength = SimdKernels::decimationHistoryLength(fmOversampling);
+            
+            for (int c = 0; c < unison; ++c) {
+                tableOsc1[c].setMorph(osc1Morph);
+                tableOsc1[c].renderPastBlock(decimationHistories[c].data(), historyLength, fmOversampling, mode);
+                tableOsc2[c].setMorph(osc2Morph);
+                tableOsc2[c].renderPastBlock(decimationHistories[constants::MAX_UNISON + c].data(), historyLength,
+                                             fmOversampling, mode);
+            }
         }
-        else {
-            output += interpolatedSample(osc1Morph, sineSample, triSample, squareSample, sawSample) * 0.2f * osc1Level;
+        
+        decimationFactor = fmOversampling;
+    }
+    
+    for (int c = 0; c < unison; ++c) {
+        WavetableOscillator& osc2 = tableOsc2[c];
+        osc2.setMorph(osc2Morph);
+        osc2.prepareLane(modulatorLanes[c], outputs + (constants::MAX_UNISON + c) * stride);
+        
+        WavetableOscillator& osc1 = tableOsc1[c];
+        osc1.setMorph(osc1Morph);
+        osc1.prepareLane(carrierLanes[c], outputs + c * stride);
+        carrierLanes[c].phaseModulation = modulatorLanes[c].output;
+        carrierLanes[c].phaseModulationDepth = fmAmount * constants::FM_MAX_DEPTH;
+        
+        // At the oversampled rate, the phase moves fmOversampling times slower (the remainder of the division is a
+        //  pitch error under 4 / 2^32)
+        modulatorLanes[c].phaseIncrement /= static_cast<uint32_t>(fmOversampling);
+        carrierLanes[c].phaseIncrement /= static_cast<uint32_t>(fmOversampling);
+    }
+    
+    return unison;
+}
+
+void Voice::decimatePhaseModulation(const SimdKernels& kernels, const float* oversampledOutputs, float* oscOutputs,
+                                    int numSamples)
+{
+    if (fmOversampling == 1) {
+        return;
+    }
+    
+    const int stride = fmOversampling * SimdKernels::oscOutputsStride;
+    
+    for (int c = 0; c < unison; ++c) {
+        kernels.decimate(oversampledOutputs + c * stride, oscOutputs + c * SimdKernels::oscOutputsStride,
+                         decimationHistories[c].data(), numSamples, fmOversampling);
+        kernels.decimate(oversampledOutputs + (constants::MAX_UNISON + c) * stride,
+                         oscOutputs + (constants::MAX_UNISON + c) * SimdKernels::oscOutputsStride,
+                         decimationHistories[constants::MAX_UNISON + c].data(), numSamples, fmOversampling);
+    }
+}
+
+void Voice::renderPolyBlepOscillators(float* oscOutputs, int numSamples)
+{
+    // The phase goes through the PolyBLEP oscillator and back to the wavetable one, so the engines can be switched
+    //  in the middle of a note
+    if (tableOsc1[0].isPlaying() && osc1Engine == oscillatorEngine::polyBlep && isOsc1Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            WavetableOscillator& osc = tableOsc1[c];
+            PolyBlepOscillator& polyBlepOsc = polyBlepOsc1[c];
+            polyBlepOsc.setMorph(osc1Morph);
+            polyBlepOsc.setPhase(osc.getPhase());
+            polyBlepOsc.renderBlock(oscOutputs + c * SimdKernels::oscOutputsStride, numSamples, nullptr);
+            osc.setPhase(polyBlepOsc.getPhase());
+        }
+    }
+    
+    if (tableOsc2[0].isPlaying() && osc2Engine == oscillatorEngine::polyBlep && isOsc2Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            WavetableOscillator& osc = tableOsc2[c];
+            PolyBlepOscillator& polyBlepOsc = polyBlepOsc2[c];
+            polyBlepOsc.setMorph(osc2Morph);
+            polyBlepOsc.setPhase(osc.getPhase());
+            polyBlepOsc.renderBlock(oscOutputs + (constants::MAX_UNISON + c) * SimdKernels::oscOutputsStride, numSamples, nullptr);
+            osc.setPhase(polyBlepOsc.getPhase());
+        }
+    }
+}
+
+void Voice::renderAdditiveOscillators(const SimdKernels& kernels, float* oscOutputs, int numSamples)
+{
+    // Like the PolyBLEP engine, the phase goes through the additive oscillator and back to the wavetable one
+    if (tableOsc1[0].isPlaying() && osc1Engine == oscillatorEngine::additive && isOsc1Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            WavetableOscillator& osc = tableOsc1[c];
+            AdditiveOscillator& additiveOsc = additiveOsc1[c];
+            additiveOsc.setMorph(osc1Morph);
+            additiveOsc.setPartials(additivePartials, additiveGains);
+            additiveOsc.setPhase(osc.getPhase());
+            additiveOsc.renderBlock(kernels, additivePartialsState, oscOutputs + c * SimdKernels::oscOutputsStride, numSamples);
+            osc.setPhase(additiveOsc.getPhase());
         }
     }
     
-    if (sineTableOsc2[note].isPlaying()) {
-        float sineSample = sineTableOsc2[note].getSample();
-        float triSample = triTableOsc2[note].getSample();
-        float squareSample = squareTableOsc2[note].getSample();
-        float sawSample = sawTableOsc2[note].getSample();
+    if (tableOsc2[0].isPlaying() && osc2Engine == oscillatorEngine::additive && isOsc2Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            WavetableOscillator& osc = tableOsc2[c];
+            AdditiveOscillator& additiveOsc = additiveOsc2[c];
+            additiveOsc.setMorph(osc2Morph);
+            additiveOsc.setPartials(additivePartials, additiveGains);
+            additiveOsc.setPhase(osc.getPhase());
+            additiveOsc.renderBlock(kernels, additivePartialsState,
+                                    oscOutputs + (constants::MAX_UNISON + c) * SimdKernels::oscOutputsStride, numSamples);
+            osc.setPhase(additiveOsc.getPhase());
+        }
+    }
+}
+
+void Voice::skipSilentOscillators(int numSamples)
+{
+    // Whatever their engine, the oscillators that are not heard only move on, so they come back at the same phase as
+    //  if they had played all along (a synced OSC2 was moved by renderSyncedOscillators)
+    if (tableOsc1[0].isPlaying() && !isOsc1Heard()) {
+        for (int c = 0; c < unison; ++c) {
+            tableOsc1[c].skipBlock(numSamples);
+        }
+    }
+    
+    if (tableOsc2[0].isPlaying() && !isOsc2Heard() && !usesHardSync()) {
+        for (int c = 0; c < unison; ++c) {
+            tableOsc2[c].skipBlock(numSamples);
+        }
+    }
+}
+
+void Voice::mixOscillators(const SimdKernels& kernels, float* output, float* rightOutput, int numSamples,
+                           const float* envelope, const float* noise, const float* oscOutputs)
+{
+    jassert(numSamples > 0 && numSamples <= constants::LOWER_UPDATE_RATE_MAX_VALUE);
+    
+    SimdKernels::OscillatorMix mix;
+    
+    // The oscillators rendered the whole chunk; only the samples before they stop are used
+    mix.osc1Outputs = tableOsc1[0].isPlaying() && isOsc1Heard() ? oscOutputs : nullptr;
+    mix.osc2Outputs = tableOsc2[0].isPlaying() && isOsc2Heard() ? oscOutputs + constants::MAX_UNISON * SimdKernels::oscOutputsStride : nullptr;
+    mix.noise = noise;
+    mix.leftGains = unisonLeftGains.data();
+    mix.rightGains = isStereo() ? unisonRightGains.data() : nullptr;
+    mix.unison = unison;
+    mix.osc1Gain = ringMod ? 0.4f : 0.2f;
+    
+    // The levels ramp, so they change (and the oscillators go in and out of the mix) without clicks; the kernel
+    //  follows the ramp in a straight line over the chunk
+    osc1LevelSmoother.setTargetValue(osc1Level);
+    osc2LevelSmoother.setTargetValue(osc2Level);
+    mix.osc1Level = osc1LevelSmoother.getCurrentValue();
+    mix.osc2Level = osc2LevelSmoother.getCurrentValue();
+    mix.osc1LevelStep = (osc1LevelSmoother.skip(numSamples) - mix.osc1Level) / static_cast<float>(numSamples);
+    mix.osc2LevelStep = (osc2LevelSmoother.skip(numSamples) - mix.osc2Level) / static_cast<float>(numSamples);
+    
+    mix.velocity = velocityAmp;
+    mix.ringMod = ringMod;
+    
+    // If the envelope is done (level extremely close to 0), the oscillators are stopped for its last sample
+    mix.oscSamples = numSamples;
+    
+    if (envelope[numSamples - 1] < constants::SILENCE_TRESHOLD) {
+        mix.oscSamples = numSamples - 1;
+    }
+    
+    kernels.mixOscillators(mix, output, rightOutput, numSamples);
+    
+    if (mix.oscSamples < numSamples) {
+        // The copies only play while the note's oscillators do, and restart with the next note, which starts
+        //  without phase modulation
+        tableOsc1[0].stop(phaseRand);
+        tableOsc2[0].stop(phaseRand);
+        phaseModulating = false;
+        phaseModulationDelay = 0.0f;
+
+        note = constants::NO_NOTE_VALUE;
+    }
+}
+
+void Voice::prepareLowPassBlock(float* buffer, float* rightBuffer, int numSamples)
+{
+    if (!isStereo()) {
+        stereoFilters = false;
+    }
+    else if (!stereoFilters) {
+        // The right channel starts from the state of the mono voice, so spreading the copies doesn't click
+        lpfRight.copyState(lpf);
+        hpfRight.copyState(hpf);
+        stereoFilters = true;
+    }
+    
+    prepareFilterBlock(lpf, lpfRight, lpfBypass, buffer, rightBuffer, numSamples);
+}
+
+void Voice::finishLowPassBlock(float* buffer, float* rightBuffer, int numSamples)
+{
+    finishFilterBlock(lpfBypass, buffer, rightBuffer, numSamples);
+}
+
+void Voice::prepareHighPassBlock(float* buffer, float* rightBuffer, int numSamples)
+{
+    prepareFilterBlock(hpf, hpfRight, hpfBypass, buffer, rightBuffer, numSamples);
+}
+
+void Voice::finishHighPassBlock(float* buffer, float* rightBuffer, int numSamples)
+{
+    finishFilterBlock(hpfBypass, buffer, rightBuffer, numSamples);
+}
+
+void Voice::prepareFilterBlock(StateVariableFilter& filter, StateVariableFilter& rightFilter, FilterBypass& bypass,
+                               float* buffer, float* rightBuffer, int numSamples)
+{
+    if (bypass.fade == FilterFade::none && bypass.transparent != bypass.bypassed) {
+        // The filter goes out of the chain, or comes back from silence (its state is from when it left)
+        bypass.fade = bypass.transparent ? FilterFade::out : FilterFade::in;
+        bypass.fadePosition = 0;
         
-        if (ringMod) {
-            output *= interpolatedSample(osc2Morph, sineSample, triSample, squareSample, sawSample) * osc2Level;
+        if (bypass.fade == FilterFade::in) {
+            filter.clearState();
+            rightFilter.clearState();
+        }
+    }
+    
+    if (bypass.fade == FilterFade::none) {
+        if (bypass.bypassed) {
+            return;
         }
-        else {
-            output -= interpolatedSample(osc2Morph, sineSample, triSample, squareSample, sawSample) * 0.2f * osc2Level;
+    }
+    else {
+        // The input is kept for the crossfade
+        std::copy(buffer, buffer + numSamples, dryBuffer.begin());
+        
+        if (stereoFilters) {
+            std::copy(rightBuffer, rightBuffer + numSamples, dryBuffer.begin() + constants::LOWER_UPDATE_RATE_MAX_VALUE);
         }
     }
     
-    // Velocity amplitude modifier
-    output = output * velocityAmp;
+    filter.prepareBlock(buffer, buffer, numSamples);
     
-    // Mix with noise
-    output = output + noise;
+    if (stereoFilters) {
+        rightFilter.prepareBlock(rightBuffer, rightBuffer, numSamples);
+    }
+}
+
+void Voice::finishFilterBlock(FilterBypass& bypass, float* buffer, float* rightBuffer, int numSamples)
+{
+    if (bypass.fade == FilterFade::none) {
+        return;
+    }
+    
+    // Linear crossfade from the filtered samples to the input (or back), which may go on over several chunks
+    const bool fadeOut = bypass.fade == FilterFade::out;
+    constexpr float step { 1.0f / static_cast<float>(constants::RAMP_SAMPLES) };
+    
+    for (int i = 0; i < numSamples; ++i) {
+        const float position = std::min(static_cast<float>(bypass.fadePosition + i + 1) * step, 1.0f);
+        const float dryWeight = fadeOut ? position : 1.0f - position;
+        buffer[i] += (dryBuffer[i] - buffer[i]) * dryWeight;
+        
+        if (stereoFilters) {
+            const float dry = dryBuffer[constants::LOWER_UPDATE_RATE_MAX_VALUE + i];
+            rightBuffer[i] += (dry - rightBuffer[i]) * dryWeight;
+        }
+    }
     
-    // Apply filter in series; first LPF, then HPF
-    output = lpf.render(output);
-    output = hpf.render(output);
+    bypass.fadePosition += numSamples;
     
-    return output * envelope;
+    if (bypass.fadePosition >= constants::RAMP_SAMPLES) {
+        bypass.bypassed = fadeOut;
+        bypass.fade = FilterFade::none;
+    }
 }
 
 void Voice::updateLFO()
@@ -102,174 +472,156 @@ void Voice::updateLFO()
     // Update coefficiants of LPF with modulation, if any
     float lpfEnvMod = lpfEnv.nextValue() * lpfEnvDepth;
     float modulatedCutoff = lpfCutoff * std::exp(lpfMod + lpfEnvMod);
-    modulatedCutoff = std::clamp(modulatedCutoff, 30.0f, 20000.0f); // clamp to prevent crazy values
-    lpf.updateCoefficiants(modulatedCutoff, lpfQ);
+    modulatedCutoff = std::clamp(modulatedCutoff, constants::FILTER_MIN_CUTOFF, constants::FILTER_MAX_CUTOFF); // clamp to prevent crazy values
+    
+    // The filters barely change the sound at the ends of the cutoff range without resonance (a Q of 1); they are
+    //  then left out of the chain, and their coefficiants are only needed again when they come back
+    lpfBypass.transparent = modulatedCutoff >= constants::FILTER_MAX_CUTOFF && lpfQ <= 1.0f;
+    
+    if (!(lpfBypass.transparent && lpfBypass.bypassed && lpfBypass.fade == FilterFade::none)) {
+        lpf.updateCoefficiants(modulatedCutoff, lpfQ);
+    }
     
     // same thing with HPF
     float hpfEnvMod = hpfEnv.nextValue() * hpfEnvDepth;
     float modulatedHpfCutoff = hpfCutoff * std::exp(hpfMod + hpfEnvMod);
-    modulatedHpfCutoff = std::clamp(modulatedHpfCutoff, 30.0f, 20000.0f);
-    hpf.updateCoefficiants(modulatedHpfCutoff, hpfQ);
-}
+    modulatedHpfCutoff = std::clamp(modulatedHpfCutoff, constants::FILTER_MIN_CUTOFF, constants::FILTER_MAX_CUTOFF);
+    hpfBypass.transparent = modulatedHpfCutoff <= constants::FILTER_MIN_CUTOFF && hpfQ <= 1.0f;
     
-float Voice::interpolatedSample(float factor, float s1, float s2, float s3, float s4) {
-    if (factor <= 0.33f) { // interpolate between sine and triangle
-        return s1 + (s2 - s1) * (factor / 0.33f);
-    } else if (factor <= 0.66f) { // interpolate between triangle and square
-        return s2 + (s3 - s2) * ((factor - 0.33f) / 0.33f);
-    } else { // interpolate between square and saw
-        return s3 + (s4 - s3) * ((factor - 0.66f) / 0.33f);
+    if (!(hpfBypass.transparent && hpfBypass.bypassed && hpfBypass.fade == FilterFade::none)) {
+        hpf.updateCoefficiants(modulatedHpfCutoff, hpfQ);
     }
+    
+    // The right channel of a stereo voice goes through the same filters
+    lpfRight.copyCoefficiants(lpf);
+    hpfRight.copyCoefficiants(hpf);
 }
-
-void Voice::initializeOscillators(float sampleRate)
-{
-    std::unique_ptr<WavetableGenerator> wavetableGen;
     
-    // Basic sine wave
-    std::vector<float> sineTab = wavetableGen->generateSineWavetable();
+void Voice::initializeOscillators(const WavetableBank& bank, float sampleRate)
+{
+    // Clear oscillators
+    tableOsc1.clear();
+    tableOsc2.clear();
+    polyBlepOsc1.clear();
+    polyBlepOsc2.clear();
+    additiveOsc1.clear();
+    additiveOsc2.clear();
     
-    // Triangle (kept simple)
-    std::vector<float> triTab = wavetableGen->generateTriangleWavetable();
+    // Every copy starts on the tables with the most harmonics; they are set again with its frequency
+    wavetableBank = &bank;
     
-    /*
-     Generate wavetables with varying number of harmonics. The number of frequencies per table
-     were kind of determined by ear (which step at which frequency gives a less jarring drop
-     in harmonics).
-     */
+    for (auto i = 0; i < constants::MAX_UNISON; ++i) {
+        tableOsc1.emplace_back(&bank.getMorphFrames(0), sampleRate);
+        tableOsc2.emplace_back(&bank.getMorphFrames(0), sampleRate);
+        polyBlepOsc1.emplace_back(sampleRate);
+        polyBlepOsc2.emplace_back(sampleRate);
+        additiveOsc1.emplace_back(sampleRate);
+        additiveOsc2.emplace_back(sampleRate);
+    }
+}
+
+void Voice::applyEngineState(const EngineState& state)
+{
+    lpf.sampleRate = state.sampleRate;
+    hpf.sampleRate = state.sampleRate;
+    lpfRight.sampleRate = state.sampleRate;
+    hpfRight.sampleRate = state.sampleRate;
     
-    // Saw
-    std::vector<float> sawTab1 = wavetableGen->generateSawtoothWavetable(368);
-    std::vector<float> sawTab2 = wavetableGen->generateSawtoothWavetable(256);
-    std::vector<float> sawTab3 = wavetableGen->generateSawtoothWavetable(128);
-    std::vector<float> sawTab4 = wavetableGen->generateSawtoothWavetable(72);
-    std::vector<float> sawTab5 = wavetableGen->generateSawtoothWavetable(50);
-    std::vector<float> sawTab6 = wavetableGen->generateSawtoothWavetable(25);
-    std::vector<float> sawTab7 = wavetableGen->generateSawtoothWavetable(10);
-    std::vector<float> sawTab8 = wavetableGen->generateSawtoothWavetable(5);
-    
-    // Square
-    std::vector<float> sqrTab1 = wavetableGen->generateSquareWavetable(368);
-    std::vector<float> sqrTab2 = wavetableGen->generateSquareWavetable(256);
-    std::vector<float> sqrTab3 = wavetableGen->generateSquareWavetable(110);
-    std::vector<float> sqrTab4 = wavetableGen->generateSquareWavetable(60);
-    std::vector<float> sqrTab5 = wavetableGen->generateSquareWavetable(40);
-    std::vector<float> sqrTab6 = wavetableGen->generateSquareWavetable(20);
-    std::vector<float> sqrTab7 = wavetableGen->generateSquareWavetable(10);
-    std::vector<float> sqrTab8 = wavetableGen->generateSquareWavetable(5);
-            
-    // Clear oscillators wavetables
-    sineTableOsc1.clear();
-    sawTableOsc1.clear();
-    triTableOsc1.clear();
-    squareTableOsc1.clear();
-    sineTableOsc2.clear();
-    sawTableOsc2.clear();
-    triTableOsc2.clear();
-    squareTableOsc2.clear();
+    wavetableBank = state.wavetableBank.get();
     
+    for (int c = 0; c < constants::MAX_UNISON; ++c) {
+        tableOsc1[c].setMorphFrames(&wavetableBank->getMorphFrames(0), state.sampleRate);
+        tableOsc2[c].setMorphFrames(&wavetableBank->getMorphFrames(0), state.sampleRate);
+        polyBlepOsc1[c].setSampleRate(state.sampleRate);
+        polyBlepOsc2[c].setSampleRate(state.sampleRate);
+        additiveOsc1[c].setSampleRate(state.sampleRate);
+        additiveOsc2[c].setSampleRate(state.sampleRate);
+    }
+}
+
+void Voice::setOscillatorFrequency(WavetableOscillator& osc, float frequency)
+{
     /*
-     As we go up in MIDI notes, we assign wavetables with less harmonics to prevent aliasing.
-     This is obviously not perfect, and could be tweaked further.
+     The oscillator points to the bank's morph frames at the harmonics level of the frequency it plays now;
+     as the frequency goes up, the bank gives tables with less harmonics to prevent aliasing.
      */
-    for (auto i = 0; i < constants::WAVETABLE_OSCILLATORS_COUNT; ++i) {
-        sineTableOsc1.emplace_back(sineTab, sampleRate);
-        sineTableOsc2.emplace_back(sineTab, sampleRate);
-        triTableOsc1.emplace_back(triTab, sampleRate);
-        triTableOsc2.emplace_back(triTab, sampleRate);
-
-        if (i < 28) {
-            sawTableOsc1.emplace_back(sawTab1, sampleRate);
-            sawTableOsc2.emplace_back(sawTab1, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab1, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab1, sampleRate);
-        }
-        else if (i < 40) {
-            sawTableOsc1.emplace_back(sawTab2, sampleRate);
-            sawTableOsc2.emplace_back(sawTab2, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab2, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab2, sampleRate);
-        }
-        else if (i < 51) {
-            sawTableOsc1.emplace_back(sawTab3, sampleRate);
-            sawTableOsc2.emplace_back(sawTab3, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab3, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab3, sampleRate);
-        }
-        else if (i < 64) {
-            sawTableOsc1.emplace_back(sawTab4, sampleRate);
-            sawTableOsc2.emplace_back(sawTab4, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab4, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab4, sampleRate);
-        }
-        else if (i < 75) {
-            sawTableOsc1.emplace_back(sawTab5, sampleRate);
-            sawTableOsc2.emplace_back(sawTab5, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab5, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab5, sampleRate);
-        }
-        else if (i < 87) {
-            sawTableOsc1.emplace_back(sawTab6, sampleRate);
-            sawTableOsc2.emplace_back(sawTab6, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab6, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab6, sampleRate);
-        }
-        else if (i < 99) {
-            sawTableOsc1.emplace_back(sawTab7, sampleRate);
-            sawTableOsc2.emplace_back(sawTab7, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab7, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab7, sampleRate);
-        }
-        else {
-            sawTableOsc1.emplace_back(sawTab8, sampleRate);
-            sawTableOsc2.emplace_back(sawTab8, sampleRate);
-            squareTableOsc1.emplace_back(sqrTab8, sampleRate);
-            squareTableOsc2.emplace_back(sqrTab8, sampleRate);
-        }
-    }
+    const int level = WavetableBank::getLevelForFrequency(frequency);
+    osc.setMorphFrames(&wavetableBank->getMorphFrames(level), wavetableBank->getSampleRate());
+    osc.setFrequency(frequency);
 }
     
-void Voice::setFrequencyAtNote(int note, float freq)
+void Voice::setFrequency(float freq)
 {
     // OSC1
-    sineTableOsc1[note].setFrequency(freq);
-    sineTableOsc1[note].initFrequency = freq;
+    setOscillatorFrequency(tableOsc1[0], freq);
+    tableOsc1[0].initFrequency = freq;
     
-    sawTableOsc1[note].setFrequency(freq);
-    sawTableOsc1[note].initFrequency = freq;
+    // OSC2
+    setOscillatorFrequency(tableOsc2[0], freq);
+    tableOsc2[0].initFrequency = freq;
     
-    triTableOsc1[note].setFrequency(freq);
-    triTableOsc1[note].initFrequency = freq;
+    // The decimation filters don't carry the previous note over
+    decimationFactor = 0;
     
-    squareTableOsc1[note].setFrequency(freq);
-    squareTableOsc1[note].initFrequency = freq;
+    // The copies start at phases spread over the period (golden ratio steps, so any number of copies is spread
+    //  evenly), or at random phases; otherwise they would all start together, like a flanger
+    constexpr uint32_t phaseStep { 0x9E3779B9u };
     
-    // OSC2
-    sineTableOsc2[note].setFrequency(freq);
-    sineTableOsc2[note].initFrequency = freq;
+    for (int c = 1; c < constants::MAX_UNISON; ++c) {
+        WavetableOscillator& osc1 = tableOsc1[c];
+        osc1.stop(phaseRand);
+        
+        WavetableOscillator& osc2 = tableOsc2[c];
+        osc2.stop(phaseRand);
+        
+        if (!phaseRand) {
+            osc1.setPhase(static_cast<uint32_t>(c) * phaseStep);
+            osc2.setPhase(static_cast<uint32_t>(c) * phaseStep + 0x80000000u);
+        }
+    }
+}
     
-    sawTableOsc2[note].setFrequency(freq);
-    sawTableOsc2[note].initFrequency = freq;
+void Voice::modFrequency(float pitchBend, float vibratoMod, float osc2Detune)
+{
+    updateUnison();
     
-    triTableOsc2[note].setFrequency(freq);
-    triTableOsc2[note].initFrequency = freq;
+    // Apply pitch bend, vibrato and OSC2 detune (semi + cents), then the detune of every unison copy
+    const float osc1Frequency = tableOsc1[0].initFrequency * pitchBend * vibratoMod;
+    const float osc2Frequency = tableOsc2[0].initFrequency * pitchBend * osc2Detune * vibratoMod;
     
-    squareTableOsc2[note].setFrequency(freq);
-    squareTableOsc2[note].initFrequency = freq;
+    for (int c = 0; c < unison; ++c) {
+        setOscillatorFrequency(tableOsc1[c], osc1Frequency * unisonRatios[c]);
+        setOscillatorFrequency(tableOsc2[c], osc2Frequency * unisonRatios[c]);
+        polyBlepOsc1[c].setFrequency(osc1Frequency * unisonRatios[c]);
+        polyBlepOsc2[c].setFrequency(osc2Frequency * unisonRatios[c]);
+        additiveOsc1[c].setFrequency(osc1Frequency * unisonRatios[c]);
+        additiveOsc2[c].setFrequency(osc2Frequency * unisonRatios[c]);
+    }
 }
-    
-void Voice::modFrequencyAtNote(int note, float pitchBend, float vibratoMod, float osc2Detune)
+
+void Voice::updateUnison()
 {
-    // Apply pitch bend, vibrato and OSC2 detune (semi + cents)
-    sineTableOsc1[note].setFrequency(sineTableOsc1[note].initFrequency * pitchBend * vibratoMod);
-    sineTableOsc2[note].setFrequency(sineTableOsc2[note].initFrequency * pitchBend * osc2Detune * vibratoMod);
+    // Only calculated again when the unison settings change
+    if (unison == cachedUnison && unisonDetune == cachedUnisonDetune && unisonSpread == cachedUnisonSpread) {
+        return;
+    }
     
-    sawTableOsc1[note].setFrequency(sawTableOsc1[note].initFrequency * pitchBend * vibratoMod);
-    sawTableOsc2[note].setFrequency(sawTableOsc2[note].initFrequency * pitchBend * osc2Detune * vibratoMod);
+    cachedUnison = unison;
+    cachedUnisonDetune = unisonDetune;
+    cachedUnisonSpread = unisonSpread;
     
-    triTableOsc1[note].setFrequency(triTableOsc1[note].initFrequency * pitchBend * vibratoMod);
-    triTableOsc2[note].setFrequency(triTableOsc2[note].initFrequency * pitchBend * osc2Detune * vibratoMod);
+    // The copies are spread evenly between -1 (lowest and leftmost) and 1 (highest and rightmost); their levels are
+    //  divided by the square root of their number, which keeps the loudness of detuned copies
+    const float level = 1.0f / std::sqrt(static_cast<float>(unison));
     
-    squareTableOsc1[note].setFrequency(squareTableOsc1[note].initFrequency * pitchBend * vibratoMod);
-    squareTableOsc2[note].setFrequency(squareTableOsc2[note].initFrequency * pitchBend * osc2Detune * vibratoMod);
+    for (int c = 0; c < unison; ++c) {
+        const float position = unison > 1 ? 2.0f * static_cast<float>(c) / static_cast<float>(unison - 1) - 1.0f : 0.0f;
+        unisonRatios[c] = std::exp2(unisonDetune * position / 1200.0f);
+        
+        // LRN constant-power panning: the gains are the cosine and sine of an angle going from 0 (left) to pi/2
+        //  (right), so the power stays the same anywhere; at the center, both gains are sqrt(2)/2
+        const float angle = (unisonSpread * position + 1.0f) * constants::PI_OVER_FOUR;
+        unisonLeftGains[c] = isStereo() ? std::cos(angle) * juce::MathConstants<float>::sqrt2 * level : level;
+        unisonRightGains[c] = isStereo() ? std::sin(angle) * juce::MathConstants<float>::sqrt2 * level : level;
+    }
 }
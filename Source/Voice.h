@@ -13,16 +13,35 @@
 #include <JuceHeader.h>
 #include "Constants.h"
 #include "WavetableOscillator.h"
+#include "PolyBlepOscillator.h"
+#include "AdditiveOscillator.h"
 #include "Envelope.h"
 #include "LowPassFilter.h"
 #include "HighPassFilter.h"
-#include "WavetableGenerator.h"
+#include "WavetableBank.h"
+#include "EngineStateBuilder.h"
+#include "SimdKernels.h"
+
+/**
+ The state of every voice that changes with every sample (envelopes and filters), stored as arrays of one slot per
+ voice, so rendering the voices together goes through a few cache lines instead of a large object per voice.
+ */
+struct VoiceStates
+{
+    Envelope::States env;
+    Envelope::States lpfEnv;
+    Envelope::States hpfEnv;
+    StateVariableFilter::States lpf;
+    StateVariableFilter::States hpf;
+};
 
 /**
  Represents a voice for the synthesizer; produces the next output sample for a given note.
- The synthesizer can have multiple voices in polyphony.
+ The synthesizer can have multiple voices in polyphony. Its envelopes and filters are views of its slot of a
+ VoiceStates, set with bind. Voices start on a cache line, so two of them rendered by different threads never share
+ one.
  */
-class Voice
+class alignas(64) Voice
 {
 public:
     int note; // MIDI note number for the current voice
@@ -37,10 +56,22 @@ public:
     bool ringMod; // ring mod toggle
     bool sustained; // sustain toggle
     bool phaseRand; // phase randomizer toggle
+    int unison; // copies of each oscillator, 1 to constants::MAX_UNISON
+    float unisonDetune; // detune of the highest copy (and of the lowest one, downwards), in cents
+    float unisonSpread; // stereo width of the copies, from 0 (mono) to 1
+    oscillatorEngine::Engine osc1Engine; // OSC1 engine
+    oscillatorEngine::Engine osc2Engine; // OSC2 engine
+    float fmAmount; // phase modulation of OSC1 by OSC2, from 0 to 1
+    int fmOversampling; // oversampling factor of the phase modulation (1, 2 or 4)
+    bool hardSync; // OSC2 restarts with every period of OSC1
+    int additivePartials; // most partials of the additive oscillators, 1 to constants::MAX_PARTIALS
+    const float* additiveGains; // gain of every partial of the additive oscillators (nullptr for none), owned by Synth
     
-    // filters values
+    // filters values; the right filters are the second channel of a stereo voice, with the same coefficiants
     LowPassFilter lpf;
     HighPassFilter hpf;
+    LowPassFilter lpfRight;
+    HighPassFilter hpfRight;
     float lpfCutoff;
     float hpfCutoff;
     float lpfQ;
@@ -48,16 +79,20 @@ public:
     float lpfMod;
     float hpfMod;
     
-    // OSC wavetables
-    std::vector<WavetableOscillator> sineTableOsc1;
-    std::vector<WavetableOscillator> triTableOsc1;
-    std::vector<WavetableOscillator> squareTableOsc1;
-    std::vector<WavetableOscillator> sawTableOsc1;
+    // Every copy of OSC1 and OSC2 for the wavetable engine, with their own phases (copy 0 is the note's oscillator,
+    //  the others are the unison copies); each one reads the tables of the bank at the harmonics level of its current
+    //  frequency
+    std::vector<WavetableOscillator> tableOsc1;
+    std::vector<WavetableOscillator> tableOsc2;
     
-    std::vector<WavetableOscillator> sineTableOsc2;
-    std::vector<WavetableOscillator> triTableOsc2;
-    std::vector<WavetableOscillator> squareTableOsc2;
-    std::vector<WavetableOscillator> sawTableOsc2;
+    // Every copy of OSC1 and OSC2 for the PolyBLEP engine; they play from the phase of the wavetable oscillators,
+    //  which keep the phase of the note whatever the engine
+    std::vector<PolyBlepOscillator> polyBlepOsc1;
+    std::vector<PolyBlepOscillator> polyBlepOsc2;
+    
+    // Every copy of OSC1 and OSC2 for the additive engine, which also play from the phase of the wavetable oscillators
+    std::vector<AdditiveOscillator> additiveOsc1;
+    std::vector<AdditiveOscillator> additiveOsc2;
     
     // envelopes
     Envelope env;
@@ -66,6 +101,12 @@ public:
     float lpfEnvDepth;
     float hpfEnvDepth;
 
+    /**
+     Makes the voice's envelopes and filters views of a slot of states (the right filters use the slot's right
+     channel), which must stay alive as long as the voice is used.
+     */
+    void bind(VoiceStates& states, int slot);
+    
     /**
      Resets the state of the voice instance and its components.
      */
@@ -77,9 +118,122 @@ public:
     void release();
     
     /**
-      The core function of this class. Renders the next values of the oscillators. Also takes noise as input.
+     Returns true if the unison copies are spread in the stereo field, so the voice has two channels after its
+     oscillators.
+     */
+    bool isStereo() const;
+    
+    /**
+     Makes the next chunk start at the current levels of the oscillators, without ramping from the levels of the last
+     note. This is called on new notes.
+     */
+    void snapLevels();
+    
+    /**
+     Adds the lanes of the voice's playing wavetable oscillators (every unison copy) to lanes, so they are rendered by
+     the SIMD kernels in oscOutputs: the copies of OSC1, then those of OSC2 from copy constants::MAX_UNISON, every
+     SimdKernels::oscOutputsStride samples. Oscillators that are not heard in the chunk are left out (see
+     skipSilentOscillators). Returns the number of lanes added.
+     */
+    int addOscillatorLanes(WavetableOscillator::Lane* lanes, float* oscOutputs);
+    
+    /**
+     Returns true if OSC2 is hard-synced to OSC1: the sync is on, both oscillators play and OSC2 uses the wavetable
+     engine (whatever the engine of OSC1). OSC2 is then left out of addOscillatorLanes and rendered by
+     renderSyncedOscillators instead.
+     */
+    bool usesHardSync();
+    
+    /**
+     Renders the next numSamples samples of every copy of OSC2 hard-synced to the same copy of OSC1 in oscOutputs,
+     at the same places as addOscillatorLanes; does nothing without usesHardSync(). OSC1 must not have played the
+     samples yet, since the resets are found from its phase. When OSC2 is not heard, its phase only follows the resets.
+     */
+    void renderSyncedOscillators(float* oscOutputs, int numSamples, interpolation::Mode mode);
+    
+    /**
+     Returns true if OSC2 modulates the phase of OSC1, so its oscillators go through addPhaseModulationLanes instead
+     of addOscillatorLanes. The modulation starts when the FM amount is not zero and OSC1 is heard, while OSC2 is not
+     hard-synced to OSC1 and both oscillators play and use the wavetable engine (the PolyBLEP engine has no phase
+     modulation). It then goes on until the note ends, even without depth or with OSC1 silent, unless the engines or
+     the hard sync change: the decimation delays the oscillators, so going in and out of it would click.
+     */
+    bool usesPhaseModulation();
+    
+    /**
+     Fills the lanes of OSC2 (modulatorLanes) and OSC1 (carrierLanes, modulated by the same copy of OSC2) for every
+     unison copy; the lanes play fmOversampling times slower, for fmOversampling chunks of the block's length.
+     Without oversampling, they are rendered at the places of addOscillatorLanes in oscOutputs; otherwise, they are
+     rendered at the same places in oversampledOutputs, with fmOversampling times as many samples, for
+     decimatePhaseModulation. When the oversampling starts or changes, the oscillators move on by the delay of the
+     decimation, and its filters start from what they played before with an interpolation mode. Returns the number of
+     lanes added to each of modulatorLanes and carrierLanes.
+     */
+    int addPhaseModulationLanes(WavetableOscillator::Lane* modulatorLanes, WavetableOscillator::Lane* carrierLanes,
+                                float* oversampledOutputs, float* oscOutputs, interpolation::Mode mode);
+    
+    /**
+     Brings the oscillators rendered from addPhaseModulationLanes back to the sample rate: both oscillators of every
+     copy are filtered and decimated from oversampledOutputs to oscOutputs (so they stay aligned).
+     */
+    void decimatePhaseModulation(const SimdKernels& kernels, const float* oversampledOutputs, float* oscOutputs,
+                                 int numSamples);
+    
+    /**
+     Renders the next numSamples samples of the playing oscillators set to the PolyBLEP engine in oscOutputs, at the
+     same places as addOscillatorLanes.
+     */
+    void renderPolyBlepOscillators(float* oscOutputs, int numSamples);
+    
+    /**
+     Renders the next numSamples samples of the playing oscillators set to the additive engine in oscOutputs with the
+     kernels, at the same places as addOscillatorLanes.
+     */
+    void renderAdditiveOscillators(const SimdKernels& kernels, float* oscOutputs, int numSamples);
+    
+    /**
+     Moves the phase of the playing oscillators that are not heard in the chunk (at a level of 0, or ring-modulated
+     by an oscillator at a level of 0) on by numSamples samples, without rendering them. This is called after the
+     oscillators are rendered.
      */
-    float render(float noise);
+    void skipSilentOscillators(int numSamples);
+    
+    /**
+      The core function of this class. Mixes the next numSamples samples of the oscillators (rendered from
+      addOscillatorLanes in oscOutputs) with velocity and noise (nullptr for none) in output (and in rightOutput for a
+      stereo voice), ready for the filters (see prepareLowPassBlock); the result is then multiplied by envelope, the values
+      of the amplitude envelope (rendered by the kernels). The levels of the oscillators ramp to their new values over
+      constants::RAMP_SAMPLES samples. The oscillators stop when the envelope is done.
+      A chunk is at most constants::LOWER_UPDATE_RATE_MAX_VALUE samples long, so the modulations (updated by
+      updateLFO) stay constant in it.
+     */
+    void mixOscillators(const SimdKernels& kernels, float* output, float* rightOutput, int numSamples,
+                        const float* envelope, const float* noise, const float* oscOutputs);
+    
+    /**
+     Prepares the voice's low-pass filters, so the SIMD kernels filter the numSamples samples of buffer (and of
+     rightBuffer for a stereo voice) in place; nothing is prepared while the filter is left out of the chain because
+     it wouldn't change the sound (see updateLFO).
+     The filters are applied in series: the low-pass filters are rendered and finished first, then the high-pass
+     filters.
+     */
+    void prepareLowPassBlock(float* buffer, float* rightBuffer, int numSamples);
+    
+    /**
+     Finishes the block prepared by prepareLowPassBlock, with the same buffers. When the filter goes in or out of the
+     chain, its output is crossfaded with its input over constants::RAMP_SAMPLES samples, so it doesn't click.
+     */
+    void finishLowPassBlock(float* buffer, float* rightBuffer, int numSamples);
+    
+    /**
+     Same as prepareLowPassBlock for the high-pass filters.
+     */
+    void prepareHighPassBlock(float* buffer, float* rightBuffer, int numSamples);
+    
+    /**
+     Same as finishLowPassBlock for the high-pass filters.
+     */
+    void finishHighPassBlock(float* buffer, float* rightBuffer, int numSamples);
     
     /**
      Update various modulations on the voice according to modulation values from Synth.
@@ -87,28 +241,112 @@ public:
     void updateLFO();
 
     /**
-     Initializes the wavetable oscillators to be used by this voice.
-     This should only be called whenever the sample rate is set, or when it changes.
+     Initializes the wavetable oscillators to be used by this voice. The oscillators read from the tables
+     of the bank, which must stay alive as long as they are used.
+     This should only be called the first time the sample rate is set (see applyEngineState for later changes).
      */
-    void initializeOscillators(float sampleRate);
+    void initializeOscillators(const WavetableBank& bank, float sampleRate);
     
     /**
-     Sets the frequency for the wavetables at MIDI note index in each wavetable vectors.
-     This is called on new notes.
+     Points the existing oscillators and filters to a new engine state (wavetables and sample rate); the frequency
+     of a playing note must be set again after this. Nothing is allocated, so this can be called on the audio thread.
      */
-    void setFrequencyAtNote(int note, float freq);
+    void applyEngineState(const EngineState& state);
     
     /**
-     Modifies the frequency for the wavetables at MIDI note index in each wavetable vectors.
-     This is done at each render of the synth's voice to catch any changes.
+     Sets the frequency of the note's oscillators, and restarts the unison copies. This is called on new notes; a
+     stolen voice carries the phase of its note's oscillators on.
      */
-    void modFrequencyAtNote(int note, float pitchBend, float vibratoMod, float osc2Detune);
+    void setFrequency(float freq);
+    
+    /**
+     Modifies the frequency of the oscillators with pitch bend, vibrato and OSC2 detune, with the detune and stereo
+     position of every unison copy. The harmonics level of the tables follows the frequency of every copy, so
+     the oscillators stay band-limited however far the pitch moves from the note.
+     This is done at each render of the synth's voice, and at every LFO update, to catch any changes.
+     */
+    void modFrequency(float pitchBend, float vibratoMod, float osc2Detune);
     
 private:
+    // How a filter goes in or out of the chain during a chunk
+    enum class FilterFade
+    {
+        none,
+        in,
+        out
+    };
+    
+    // A filter is left out of the chain while it barely changes the sound, and comes back when it does again
+    struct FilterBypass
+    {
+        bool transparent = false; // the filter barely changes the sound at its current cutoff (see updateLFO)
+        bool bypassed = false; // the filter is out of the chain
+        FilterFade fade = FilterFade::none; // fade in progress, over constants::RAMP_SAMPLES samples
+        int fadePosition = 0; // samples of the fade already done
+    };
+    
+    // Frequency multiplier and channel gains of every unison copy, updated with the frequencies
+    std::array<float, constants::MAX_UNISON> unisonRatios {};
+    std::array<float, constants::MAX_UNISON> unisonLeftGains {};
+    std::array<float, constants::MAX_UNISON> unisonRightGains {};
+    bool stereoFilters = false; // true while the right filters are in use
+    FilterBypass lpfBypass;
+    FilterBypass hpfBypass;
+    // Input of the filter going in or out of the chain, for the crossfade (left channel, then right channel)
+    std::array<float, 2 * constants::LOWER_UPDATE_RATE_MAX_VALUE> dryBuffer {};
+    // Levels of the oscillators in the mix, ramping to osc1Level and osc2Level over constants::RAMP_SAMPLES samples
+    juce::LinearSmoothedValue<float> osc1LevelSmoother;
+    juce::LinearSmoothedValue<float> osc2LevelSmoother;
+    // Last oversampled samples of every copy of OSC1, then of OSC2, for the decimation filters
+    std::array<std::array<float, SimdKernels::decimationHistoryLength(constants::MAX_FM_OVERSAMPLING)>, 2 * constants::MAX_UNISON> decimationHistories {};
+    int decimationFactor = 0; // oversampling the histories were filled at, 0 when they must be filled again
+    bool phaseModulating = false; // the oscillators go through the phase modulation, until the note ends
+    float phaseModulationDelay = 0.0f; // samples the oscillators moved on by, for the delay of the decimation
+    // Working space of the kernels for the additive oscillators
+    AdditiveOscillator::Partials additivePartialsState;
+    const WavetableBank* wavetableBank = nullptr; // tables read by the wavetable oscillators, owned by the engine state
+    // Unison settings the ratios and gains were calculated for
+    int cachedUnison = 0;
+    float cachedUnisonDetune = 0.0f;
+    float cachedUnisonSpread = 0.0f;
+    
+    /**
+     Calculates the frequency multiplier and channel gains of every unison copy, if the unison settings changed.
+     */
+    void updateUnison();
+    
+    /**
+     Returns true if OSC1 is heard in the next chunk: its level, or the level it is ramping from, is not 0, and the
+     same goes for OSC2 with ring modulation (which multiplies them).
+     */
+    bool isOsc1Heard() const;
+    
+    /**
+     Same as isOsc1Heard() for OSC2.
+     */
+    bool isOsc2Heard() const;
+    
+    /**
+     Moves the phase of every copy of both wavetable oscillators on by the delay of the decimation at an oversampling
+     factor (none without oversampling), from the one they have moved on by so far.
+     */
+    void setPhaseModulationDelay(int oversampling);
+    
+    /**
+     Prepares a filter and its right channel for prepareLowPassBlock and prepareHighPassBlock.
+     */
+    void prepareFilterBlock(StateVariableFilter& filter, StateVariableFilter& rightFilter, FilterBypass& bypass,
+                            float* buffer, float* rightBuffer, int numSamples);
+    
+    /**
+     Finishes the block of a filter and of its right channel for finishLowPassBlock and finishHighPassBlock.
+     */
+    void finishFilterBlock(FilterBypass& bypass, float* buffer, float* rightBuffer, int numSamples);
+    
     /**
-     Returns the interpolated sample across the four wave shapes.
-     Depending on factor value, interpolate between s1 and s2, s2 and s3 or s3 and s4.
+     Sets the frequency of a wavetable oscillator, and points it to the morph frames of the bank at the harmonics
+     level of that frequency.
      */
-    float interpolatedSample(float factor, float s1, float s2, float s3, float s4);
+    void setOscillatorFrequency(WavetableOscillator& osc, float frequency);
 };
 
@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    WavetableBank.cpp
+    Created: 2 Oct 2026 9:12:41am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "WavetableBank.h"
+#include "WavetableGenerator.h"
+#include "BaseWavetables.h"
+#include "ParallelPreparation.h"
+#include <map>
+#include <algorithm>
+
+namespace
+{
+    // Float tables are used as they are...
+    [[maybe_unused]] const float* useBaseTable(const baseWavetables::Table& table, std::vector<float>& /*storage*/)
+    {
+        return table.data();
+    }
+
+    // ...other formats need an encoded copy of the table
+    template <typename Sample>
+    const Sample* useBaseTable(const baseWavetables::Table& table, std::vector<Sample>& storage)
+    {
+        const size_t start = storage.size();
+        jassert(storage.capacity() >= start + table.size()); // the previous tables must not move
+
+        for (float value : table) {
+            storage.push_back(WavetableFormat::encode(value));
+        }
+
+        return storage.data() + start;
+    }
+}
+
+std::shared_ptr<const WavetableBank> WavetableBank::getSharedBank(float sampleRate)
+{
+    return getOrCreateSharedBank(sampleRate, true);
+}
+
+std::shared_ptr<const WavetableBank> WavetableBank::findSharedBank(float sampleRate)
+{
+    return getOrCreateSharedBank(sampleRate, false);
+}
+
+std::shared_ptr<const WavetableBank> WavetableBank::getOrCreateSharedBank(float sampleRate, bool createIfMissing)
+{
+    // LRN a weak_ptr does not keep the bank alive; it only lets us get it back (lock()) if
+    //  someone else still owns it, so each bank is freed with the last synth instance using it
+    static std::map<int, std::weak_ptr<const WavetableBank>> sharedBanks;
+    // The map has its own lock, only held to look a bank up or add it, so findSharedBank() never waits for a bank
+    //  being generated; creation has another one, so two synths don't build the same bank at once
+    static juce::CriticalSection banksLock;
+    static juce::CriticalSection creationLock;
+
+    // Sample rates are compared in whole Hz
+    const int key = juce::roundToInt(sampleRate);
+
+    const auto find = [key] {
+        const juce::ScopedLock sl(banksLock);
+        return sharedBanks[key].lock();
+    };
+
+    auto bank = find();
+
+    if (bank != nullptr || !createIfMissing) {
+        return bank;
+    }
+
+    const juce::ScopedLock sl(creationLock);
+
+    // Another synth may have created it while this one waited
+    bank = find();
+
+    if (bank == nullptr) {
+        // The constructor is private, so std::make_shared can't be used here
+        bank = std::shared_ptr<const WavetableBank>(new WavetableBank(sampleRate));
+
+        const juce::ScopedLock banksSl(banksLock);
+        sharedBanks[key] = bank;
+    }
+
+    return bank;
+}
+
+WavetableBank::WavetableBank(float sampleRate) : sampleRate{ sampleRate }
+{
+    const auto specs = getTableSpecs(sampleRate);
+    const WavetableSample* samples;
+
+    // Use the tables saved by a previous session if possible...
+    cacheFile = WavetableCache::load(sampleRate, specs);
+
+    if (cacheFile != nullptr) {
+        samples = WavetableCache::getSamples(*cacheFile);
+    }
+    else {
+        // ...otherwise generate them, and save them for next time
+        generateTables(specs);
+        samples = generatedSamples.data();
+
+        if (!WavetableCache::store(sampleRate, specs, samples)) {
+            DBG("Could not write the wavetable cache file");
+        }
+    }
+
+    baseSamples.reserve(2 * constants::WAVETABLE_STRIDE);
+    const WavetableSample* sineTable = useBaseTable(baseWavetables::sine, baseSamples);
+    const WavetableSample* triangleTable = useBaseTable(baseWavetables::triangle, baseSamples);
+
+    // Point every table either to the compile-time tables or to the next table of the samples
+    for (int level = 0; level < constants::WAVETABLE_LEVELS_COUNT; ++level) {
+        const int harmonicsLimit = getHarmonicsLimit(level, sampleRate);
+
+        for (int shape = 0; shape < numShapes; ++shape) {
+            if (shape == sine) {
+                morphFrames[level][shape] = sineTable;
+            }
+            else if (isBaseTable(static_cast<Shape>(shape), harmonicsLimit)) {
+                morphFrames[level][shape] = triangleTable;
+            }
+            else {
+                morphFrames[level][shape] = samples;
+                samples += constants::WAVETABLE_STRIDE;
+            }
+        }
+    }
+}
+
+bool WavetableBank::isBaseTable(Shape shape, int harmonicsLimit)
+{
+    // The triangle only changes when the limit cuts some of its harmonics
+    return shape == sine || (shape == triangle && harmonicsLimit >= constants::TRIANGLE_MAX_HARMONIC);
+}
+
+std::vector<WavetableCache::TableSpec> WavetableBank::getTableSpecs(float sampleRate)
+{
+    std::vector<WavetableCache::TableSpec> specs;
+
+    // Tables are stored level by level, in the order of the Shape enum
+    for (int level = 0; level < constants::WAVETABLE_LEVELS_COUNT; ++level) {
+        const int harmonicsLimit = getHarmonicsLimit(level, sampleRate);
+
+        for (int shape = 0; shape < numShapes; ++shape) {
+            if (!isBaseTable(static_cast<Shape>(shape), harmonicsLimit)) {
+                specs.push_back({ static_cast<uint32_t>(shape),
+                                  static_cast<uint32_t>(harmonicsLimit),
+                                  static_cast<uint32_t>(constants::WAVETABLE_STRIDE),
+                                  0 });
+            }
+        }
+    }
+
+    return specs;
+}
+
+void WavetableBank::generateTables(const std::vector<WavetableCache::TableSpec>& specs)
+{
+    generatedSamples.resize(specs.size() * constants::WAVETABLE_STRIDE);
+    
+    // Every table is independent and has its own place in generatedSamples, so they are generated in parallel
+    ParallelPreparation::run(static_cast<int>(specs.size()), [this, &specs](int i) {
+        const auto& spec = specs[static_cast<size_t>(i)];
+        const int harmonicsLimit = static_cast<int>(spec.harmonicsLimit);
+        std::vector<float> table;
+
+        switch (spec.shape) {
+            case triangle: {
+                table = WavetableGenerator::generateTriangleWavetable(harmonicsLimit);
+                break;
+            }
+            case square: {
+                table = WavetableGenerator::generateSquareWavetable(harmonicsLimit);
+                break;
+            }
+            default: { // sawtooth
+                table = WavetableGenerator::generateSawtoothWavetable(harmonicsLimit);
+                break;
+            }
+        }
+
+        // Copy the table, then its first samples again as guard samples
+        const auto destination = generatedSamples.begin() + i * constants::WAVETABLE_STRIDE;
+        const auto encode = [](float value) { return WavetableFormat::encode(value); };
+
+        std::transform(table.begin(), table.end(), destination, encode);
+        std::transform(table.begin(), table.begin() + constants::WAVETABLE_GUARD_SAMPLES,
+                       destination + constants::WAVETABLE_LENGTH, encode);
+    });
+}
+
+const WavetableSample* WavetableBank::getTable(Shape shape, int level) const
+{
+    jassert(shape < numShapes && level >= 0 && level < constants::WAVETABLE_LEVELS_COUNT);
+    return morphFrames[level][shape];
+}
+
+const WavetableBank::MorphFrames& WavetableBank::getMorphFrames(int level) const
+{
+    jassert(level >= 0 && level < constants::WAVETABLE_LEVELS_COUNT);
+    return morphFrames[level];
+}
+
+float WavetableBank::getSampleRate() const
+{
+    return sampleRate;
+}
+
+int WavetableBank::getLevelForFrequency(float frequency)
+{
+    // The level is the number of octaves above the first level's highest frequency, rounded up.
+    // LRN frexp splits a float in a mantissa in [0.5, 1) and a power of 2 exponent, which gives
+    //  ceil(log2(x)) without calling log2 : an exact power of two has a mantissa of 0.5
+    const float ratio = frequency / constants::WAVETABLE_FIRST_LEVEL_MAX_FREQUENCY;
+
+    if (ratio <= 1.0f) { return 0; }
+
+    int exponent;
+    const float mantissa = std::frexp(ratio, &exponent);
+    const int level = (mantissa == 0.5f) ? exponent - 1 : exponent;
+
+    return std::min(level, constants::WAVETABLE_LEVELS_COUNT - 1);
+}
+
+int WavetableBank::getHarmonicsLimit(int level, float sampleRate)
+{
+    // Highest fundamental played on this level
+    const float maxFrequency = constants::WAVETABLE_FIRST_LEVEL_MAX_FREQUENCY * static_cast<float>(1 << level);
+    const int limit = static_cast<int>(0.5f * sampleRate / maxFrequency);
+
+    // Always keep the fundamental, even if it goes over Nyquist on the last level
+    return juce::jlimit(1, WavetableGenerator::getMaxHarmonics(), limit);
+}
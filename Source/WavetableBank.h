@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    WavetableBank.h
+    Created: 2 Oct 2026 9:12:41am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "Constants.h"
+#include "WavetableCache.h"
+#include "WavetableFormats.h"
+
+/**
+ This class holds every wavetable used by the synth's oscillators, for every wave shape and every harmonics level.
+ The tables are generated once and are never modified afterwards, so a single bank can be shared by all the voices
+ and oscillators (and by all the plugin instances living in the same process) without any copy. Oscillators only keep
+ a pointer to the table they read from.
+
+ Each harmonics level covers one octave of fundamental frequencies, the first one ending at
+ constants::WAVETABLE_FIRST_LEVEL_MAX_FREQUENCY. The tables of a level hold every harmonic that stays under the
+ Nyquist frequency for the highest note of that octave, so the bank depends on the sample rate.
+ The sine and the full triangle never change, so they come from the compile-time tables in baseWavetables.
+ Tables are stored in the sample format chosen with CPPSYNTH_WAVETABLE_FORMAT (see WavetableFormats.h).
+ The other tables are kept on disk by the WavetableCache; a bank found in the cache is memory-mapped instead of
+ generated.
+ */
+class WavetableBank
+{
+public:
+    // Wave shapes available in the bank, in morphing order
+    enum Shape
+    {
+        sine = 0,
+        triangle,
+        square,
+        sawtooth,
+        numShapes
+    };
+    
+    /**
+     The tables of every wave shape for one harmonics level, in morphing order. Together they form a 2D table
+     indexed by morph position (frame) and phase, which oscillators read with a single bilinear lookup.
+     */
+    using MorphFrames = std::array<const WavetableSample*, numShapes>;
+
+    /**
+     Returns the bank for a sample rate, shared by the whole process. The bank is created if no other synth
+     currently holds one for this sample rate, and is freed when the last synth releases it.
+     */
+    static std::shared_ptr<const WavetableBank> getSharedBank(float sampleRate);
+
+    /**
+     Returns the bank for a sample rate if it already exists in the process, without creating it.
+     Returns nullptr if no synth currently holds a bank for this sample rate.
+     */
+    static std::shared_ptr<const WavetableBank> findSharedBank(float sampleRate);
+
+    /**
+     Returns a pointer to the first sample of the table for a wave shape and harmonics level.
+     The table contains constants::WAVETABLE_LENGTH samples followed by constants::WAVETABLE_GUARD_SAMPLES copies
+     of its first samples, stored in WavetableFormat.
+     */
+    const WavetableSample* getTable(Shape shape, int level) const;
+    
+    /**
+     Returns the morph frames (the table of every wave shape) for a harmonics level.
+     */
+    const MorphFrames& getMorphFrames(int level) const;
+
+    /**
+     Returns the sample rate the tables were generated for.
+     */
+    float getSampleRate() const;
+
+    /**
+     Returns the harmonics level to use for a fundamental frequency in Hz. Higher frequencies use tables
+     with less harmonics to prevent aliasing.
+     */
+    static int getLevelForFrequency(float frequency);
+
+    /**
+     Returns the highest harmonic that can be played without aliasing on a level, for a sample rate.
+     */
+    static int getHarmonicsLimit(int level, float sampleRate);
+
+private:
+    // LRN the generated tables live in one contiguous block of memory, which is friendlier to the cache
+    //  than many small vectors scattered across the heap
+    std::vector<WavetableSample> generatedSamples; // used when the bank was not found in the cache
+    std::vector<WavetableSample> baseSamples; // compile-time tables, when they must be converted to WavetableFormat
+    std::unique_ptr<juce::MemoryMappedFile> cacheFile; // used when the bank was found in the cache
+    std::array<MorphFrames, constants::WAVETABLE_LEVELS_COUNT> morphFrames;
+    float sampleRate;
+
+    WavetableBank(float sampleRate);
+
+    /**
+     Returns the bank for a sample rate, shared by the whole process, creating it only if createIfMissing is true.
+     */
+    static std::shared_ptr<const WavetableBank> getOrCreateSharedBank(float sampleRate, bool createIfMissing);
+
+    /**
+     Returns true if the table for a shape and harmonics limit is one of the compile-time tables.
+     */
+    static bool isBaseTable(Shape shape, int harmonicsLimit);
+
+    /**
+     Returns the spec of every table that is not a compile-time table, in storage order.
+     */
+    static std::vector<WavetableCache::TableSpec> getTableSpecs(float sampleRate);
+
+    /**
+     Generates the tables described by specs in generatedSamples, in parallel.
+     */
+    void generateTables(const std::vector<WavetableCache::TableSpec>& specs);
+
+    JUCE_DECLARE_NON_COPYABLE(WavetableBank)
+};
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    WavetableCache.cpp
+    Created: 5 Oct 2026 4:02:18pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#include "WavetableCache.h"
+
+namespace
+{
+    constexpr char cacheMagic[4] { 'C', 'S', 'W', 'T' };
+
+    // Directory set with setDirectory(), none for the default one
+    juce::CriticalSection directoryLock;
+    juce::File customDirectory;
+}
+
+std::unique_ptr<juce::MemoryMappedFile> WavetableCache::load(float sampleRate, const std::vector<TableSpec>& specs)
+{
+    const juce::File file = getCacheFile(sampleRate);
+
+    if (!file.existsAsFile()) { return nullptr; }
+
+    // LRN the OS maps the file in memory and only reads the pages when they are accessed; read-only
+    //  pages of the same file can be shared by every process that maps it
+    auto mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    const auto* data = static_cast<const char*>(mappedFile->getData());
+    const size_t size = mappedFile->getSize();
+
+    size_t samplesCount = 0;
+    for (const auto& spec : specs) {
+        samplesCount += spec.length;
+    }
+
+    const size_t expectedSize = sizeof(FileHeader) + specs.size() * sizeof(TableSpec) + samplesCount * sizeof(WavetableSample);
+
+    if (data == nullptr || size != expectedSize) { return nullptr; }
+
+    // Check that the file holds exactly the tables we need
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(FileHeader));
+
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.version != version
+        || header.sampleRate != static_cast<uint32_t>(juce::roundToInt(sampleRate))
+        || header.tablesCount != specs.size()) {
+        return nullptr;
+    }
+
+    if (std::memcmp(data + sizeof(FileHeader), specs.data(), specs.size() * sizeof(TableSpec)) != 0) {
+        return nullptr;
+    }
+
+    return mappedFile;
+}
+
+bool WavetableCache::store(float sampleRate, const std::vector<TableSpec>& specs, const WavetableSample* samples)
+{
+    const juce::File file = getCacheFile(sampleRate);
+
+    if (file.getParentDirectory().createDirectory().failed()) { return false; }
+
+    size_t samplesCount = 0;
+    for (const auto& spec : specs) {
+        samplesCount += spec.length;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = version;
+    header.sampleRate = static_cast<uint32_t>(juce::roundToInt(sampleRate));
+    header.tablesCount = static_cast<uint32_t>(specs.size());
+
+    // LRN the file is written next to the target, then moved over it in one step, so another plugin
+    //  instance never maps a half-written cache file
+    juce::TemporaryFile tempFile(file);
+
+    {
+        juce::FileOutputStream out(tempFile.getFile());
+
+        if (!out.openedOk()) { return false; }
+
+        bool written = out.write(&header, sizeof(FileHeader));
+        written = written && out.write(specs.data(), specs.size() * sizeof(TableSpec));
+        written = written && out.write(samples, samplesCount * sizeof(WavetableSample));
+        out.flush();
+
+        if (!written || out.getStatus().failed()) { return false; }
+    }
+
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+const WavetableSample* WavetableCache::getSamples(const juce::MemoryMappedFile& file)
+{
+    FileHeader header;
+    std::memcpy(&header, file.getData(), sizeof(FileHeader));
+
+    const auto* data = static_cast<const char*>(file.getData());
+    return reinterpret_cast<const WavetableSample*>(data + sizeof(FileHeader) + header.tablesCount * sizeof(TableSpec));
+}
+
+void WavetableCache::setDirectory(const juce::File& directory)
+{
+    const juce::ScopedLock lock(directoryLock);
+    customDirectory = directory;
+}
+
+juce::File WavetableCache::getCacheFile(float sampleRate)
+{
+    const juce::String fileName = "wavetables_v" + juce::String(version)
+                                + "_" + juce::String(WavetableFormat::name)
+                                + "_" + juce::String(constants::WAVETABLE_LENGTH)
+                                + "_" + juce::String(juce::roundToInt(sampleRate)) + ".bin";
+
+    const juce::ScopedLock lock(directoryLock);
+
+    if (customDirectory != juce::File()) {
+        return customDirectory.getChildFile(fileName);
+    }
+
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("cppsynth")
+        .getChildFile("WavetableCache")
+        .getChildFile(fileName);
+}
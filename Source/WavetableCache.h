@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    WavetableCache.h
+    Created: 5 Oct 2026 4:02:18pm
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+#include "Constants.h"
+#include "WavetableFormats.h"
+
+/**
+ This class stores generated wavetable banks in binary files on the local disk, so that they don't need to be
+ generated again the next time the plugin is loaded at the same sample rate.
+ There is one file per sample rate, table length and sample format. The file starts with a header, followed by the spec of every
+ table it contains (shape, harmonics limit, length) and finally by all the samples. Cached files are memory-mapped
+ read-only, so loading them does no math and the pages can be shared between processes.
+ */
+class WavetableCache
+{
+public:
+    /**
+     Describes one table of a bank. The table's samples only depend on these values.
+     */
+    struct TableSpec
+    {
+        uint32_t shape;
+        uint32_t harmonicsLimit;
+        uint32_t length; // stored samples, guard samples included
+        uint32_t reserved; // keeps the specs 16 bytes long
+    };
+
+    /**
+     Memory-maps the cache file for a sample rate, if it exists and contains exactly the tables described by
+     specs. Returns nullptr on a miss; the samples of the tables, one after the other, are at getSamples().
+     */
+    static std::unique_ptr<juce::MemoryMappedFile> load(float sampleRate, const std::vector<TableSpec>& specs);
+
+    /**
+     Writes the tables described by specs to the cache file for a sample rate.
+     Returns false if the file could not be written.
+     */
+    static bool store(float sampleRate, const std::vector<TableSpec>& specs, const WavetableSample* samples);
+
+    /**
+     Returns a pointer to the first sample in a file loaded with load().
+     */
+    static const WavetableSample* getSamples(const juce::MemoryMappedFile& file);
+
+    /**
+     Keeps the cache files in another directory, or in the default one again with juce::File(). Only the banks
+     loaded or stored afterwards are affected; the benchmarks use it to start from an empty cache.
+     */
+    static void setDirectory(const juce::File& directory);
+
+private:
+    // Bump this whenever the generated tables change, so old cache files are ignored
+    static constexpr uint32_t version { 4 };
+
+    /**
+     Header at the start of every cache file. The size is a multiple of 16 bytes, so the samples that follow
+     the specs stay aligned.
+     */
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t sampleRate;
+        uint32_t tablesCount;
+    };
+
+    /**
+     Returns the cache file for a sample rate.
+     */
+    static juce::File getCacheFile(float sampleRate);
+};
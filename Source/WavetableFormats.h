@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    WavetableFormats.h
+    Created: 11 Oct 2026 9:42:10am
+    Author:  Simon Perrier
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+ #include <immintrin.h>
+ #define CPPSYNTH_WAVETABLE_FORMATS_SSE2 1
+#endif
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+ #define CPPSYNTH_WAVETABLE_FORMATS_F16C 1
+#endif
+
+/**
+ Sample format of the wavetables stored in the WavetableBank (and in its cache files):
+ 0: 32-bit float, 1: 16-bit integer, 2: 16-bit float.
+ The 16-bit formats halve the memory used by the tables, and the memory bandwidth when many voices read different
+ tables, at the cost of some noise; Benchmarks::reportWavetableFormats() measures it for every format.
+ Set it in the exporter's preprocessor definitions to change it for a deployment.
+ */
+#ifndef CPPSYNTH_WAVETABLE_FORMAT
+ #define CPPSYNTH_WAVETABLE_FORMAT 0
+#endif
+
+/**
+ This namespace contains the sample formats the wavetables can be stored in. Each format converts float samples
+ to its storage type (encode) and back (decode), either one sample at a time or for a whole block.
+ */
+namespace wavetableFormats
+{
+    /**
+     Plain 32-bit floats; decoding does nothing.
+     */
+    struct Float32
+    {
+        using Sample = float;
+        static constexpr const char* name = "float32";
+
+        static Sample encode(float value) { return value; }
+        static float decode(Sample sample) { return sample; }
+
+        static void decode(const Sample* samples, float* output, int numSamples)
+        {
+            std::memcpy(output, samples, static_cast<size_t>(numSamples) * sizeof(float));
+        }
+    };
+
+    /**
+     16-bit integers. Band-limited tables overshoot 1 a little (Gibbs phenomenon), so the full scale of the
+     integers is [-2, 2].
+     */
+    struct Int16
+    {
+        using Sample = int16_t;
+        static constexpr const char* name = "int16";
+        static constexpr float fullScale { 2.0f };
+        static constexpr float toInt { 32767.0f / fullScale };
+        static constexpr float toFloat { fullScale / 32767.0f };
+
+        static Sample encode(float value)
+        {
+            return static_cast<Sample>(std::lround(juce::jlimit(-fullScale, fullScale, value) * toInt));
+        }
+
+        static float decode(Sample sample) { return static_cast<float>(sample) * toFloat; }
+
+        static void decode(const Sample* samples, float* output, int numSamples)
+        {
+            int i = 0;
+
+           #if CPPSYNTH_WAVETABLE_FORMATS_SSE2
+            // LRN SSE2 converts 4 samples at once: the 16-bit integers are widened to 32 bits (interleaving
+            //  them with themselves, then shifting back with their sign), converted to floats and scaled
+            const __m128 scale = _mm_set1_ps(toFloat);
+
+            for (; i + 4 <= numSamples; i += 4) {
+                const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i));
+                const __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+                _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(widened), scale));
+            }
+           #endif
+
+            for (; i < numSamples; ++i) {
+                output[i] = decode(samples[i]);
+            }
+        }
+    };
+
+    /**
+     16-bit IEEE half floats (1 sign bit, 5 exponent bits, 10 mantissa bits). The conversions use the F16C
+     instructions when the build targets them.
+     */
+    struct Float16
+    {
+        using Sample = uint16_t;
+        static constexpr const char* name = "float16";
+
+        static Sample encode(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(float));
+
+            const uint32_t sign = (bits >> 16) & 0x8000u;
+            const int exponent = static_cast<int>((bits >> 23) & 0xffu) - 127 + 15;
+            uint32_t mantissa = bits & 0x7fffffu;
+
+            // Too large for a half float (the tables never get there)
+            if (exponent >= 31) { return static_cast<Sample>(sign | 0x7c00u); }
+
+            // Too small for a normal half float: keep what fits in a subnormal one
+            if (exponent <= 0) {
+                if (exponent < -10) { return static_cast<Sample>(sign); }
+
+                mantissa |= 0x800000u; // implicit leading 1 of the float
+                return static_cast<Sample>(sign | roundShift(mantissa, 14 - exponent));
+            }
+
+            // Rounding up can carry into the exponent, which is what we want
+            return static_cast<Sample>(sign | ((static_cast<uint32_t>(exponent) << 10) + roundShift(mantissa, 13)));
+        }
+
+        static float decode(Sample sample)
+        {
+           #if CPPSYNTH_WAVETABLE_FORMATS_F16C
+            return _cvtsh_ss(sample);
+           #else
+            const uint32_t sign = static_cast<uint32_t>(sample & 0x8000u) << 16;
+            const uint32_t exponent = (sample >> 10) & 0x1fu;
+            const uint32_t mantissa = sample & 0x3ffu;
+
+            // Zero and subnormals are exact in a float
+            if (exponent == 0) {
+                const float value = static_cast<float>(mantissa) / 16777216.0f;
+                return sign != 0 ? -value : value;
+            }
+
+            const uint32_t bits = sign | (exponent == 31 ? 0x7f800000u : (exponent + 127 - 15) << 23) | (mantissa << 13);
+
+            float value;
+            std::memcpy(&value, &bits, sizeof(float));
+            return value;
+           #endif
+        }
+
+        static void decode(const Sample* samples, float* output, int numSamples)
+        {
+            int i = 0;
+
+           #if CPPSYNTH_WAVETABLE_FORMATS_F16C
+            for (; i + 4 <= numSamples; i += 4) {
+                const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i));
+                _mm_storeu_ps(output + i, _mm_cvtph_ps(packed));
+            }
+           #endif
+
+            for (; i < numSamples; ++i) {
+                output[i] = decode(samples[i]);
+            }
+        }
+
+    private:
+        /**
+         Shifts value right, rounding to the nearest (ties to even) instead of truncating.
+         */
+        static uint32_t roundShift(uint32_t value, int shift)
+        {
+            const uint32_t shifted = value >> shift;
+            const uint32_t rest = value & ((1u << shift) - 1u);
+            const uint32_t halfway = 1u << (shift - 1);
+
+            return (rest > halfway || (rest == halfway && (shifted & 1u) != 0)) ? shifted + 1 : shifted;
+        }
+    };
+
+   #if CPPSYNTH_WAVETABLE_FORMAT == 1
+    using Selected = Int16;
+   #elif CPPSYNTH_WAVETABLE_FORMAT == 2
+    using Selected = Float16;
+   #else
+    using Selected = Float32;
+   #endif
+}
+
+// Format and sample type of the tables in the WavetableBank
+using WavetableFormat = wavetableFormats::Selected;
+using WavetableSample = WavetableFormat::Sample;
@@ -10,57 +10,94 @@
 
 #include "WavetableGenerator.h"
 
+namespace
+{
+    // FFT order for a table of constants::WAVETABLE_LENGTH samples (2^11 = 2048)
+    constexpr int fftOrder { 11 };
+    static_assert((1 << fftOrder) == constants::WAVETABLE_LENGTH, "FFT order must match the wavetable length");
+}
+
 std::vector<float> WavetableGenerator::generateSineWavetable() {
-    std::vector<float> waveTable = std::vector<float>(constants::WAVETABLE_LENGTH);
+    return generateFromHarmonics(getSineHarmonics());
+}
 
-    for (int i = 0; i < constants::WAVETABLE_LENGTH; ++i) {
-        waveTable[i] = std::sinf(2 * constants::PI * static_cast<float>(i) / constants::WAVETABLE_LENGTH);
-    }
+std::vector<float> WavetableGenerator::generateTriangleWavetable(int harmonicsLimit) {
+    return generateFromHarmonics(getTriangleHarmonics(std::min(harmonicsLimit, constants::TRIANGLE_MAX_HARMONIC)));
+}
+
+std::vector<float> WavetableGenerator::generateSquareWavetable(int harmonicsLimit) {
+    return generateFromHarmonics(getSquareHarmonics(std::min(harmonicsLimit, getMaxHarmonics())));
+}
+
+std::vector<float> WavetableGenerator::generateSawtoothWavetable(int harmonicsLimit) {
+    return generateFromHarmonics(getSawtoothHarmonics(std::min(harmonicsLimit, getMaxHarmonics())));
+}
 
-    return waveTable;
+std::vector<float> WavetableGenerator::getSineHarmonics() {
+    std::vector<float> amplitudes(2, 0.f);
+    amplitudes[1] = 1.f;
+
+    return amplitudes;
 }
 
-std::vector<float> WavetableGenerator::generateTriangleWavetable() {
-    std::vector<float> waveTable = std::vector<float>(constants::WAVETABLE_LENGTH, 0.f);
+std::vector<float> WavetableGenerator::getTriangleHarmonics(int lastHarmonic) {
+    std::vector<float> amplitudes(static_cast<size_t>(std::max(lastHarmonic, 1) + 1), 0.f);
+
+    // Odd harmonics only, with alternating signs and 1/n^2 amplitudes
+    for (int n = 1; n <= lastHarmonic; n += 2) {
+        const float sign = ((n / 2) % 2 == 0) ? -1.f : 1.f;
+        amplitudes[n] = 8.f / (constants::PI * constants::PI) * sign / static_cast<float>(n * n);
+    }
+
+    return amplitudes;
+}
 
-    // For the triangle wavetable, I feel that 10 harmonics is enough
-    int harmonicsCount = 10;
+std::vector<float> WavetableGenerator::getSquareHarmonics(int lastHarmonic) {
+    std::vector<float> amplitudes(static_cast<size_t>(std::max(lastHarmonic, 1) + 1), 0.f);
 
-    for (int k = 1; k <= harmonicsCount; ++k) {
-        for (int j = 0; j < constants::WAVETABLE_LENGTH; ++j) {
-            const float phase = 2.f * constants::PI * 1.f * j / constants::WAVETABLE_LENGTH;
-            
-            waveTable[j] += 8.f / std::pow(constants::PI, 2.f) * std::pow(-1.f, k) * std::pow(2 * k - 1, -2.f) * std::sin((2.f * k - 1.f) * phase);
-            }
+    // Odd harmonics only, with 1/n amplitudes
+    for (int n = 1; n <= lastHarmonic; n += 2) {
+        amplitudes[n] = 4.f / constants::PI / static_cast<float>(n);
     }
 
-    return waveTable;
+    return amplitudes;
 }
 
-std::vector<float> WavetableGenerator::generateSquareWavetable(int harmonicsCount) {
-    std::vector<float> waveTable = std::vector<float>(constants::WAVETABLE_LENGTH, 0.f);
+std::vector<float> WavetableGenerator::getSawtoothHarmonics(int lastHarmonic) {
+    std::vector<float> amplitudes(static_cast<size_t>(std::max(lastHarmonic, 1) + 1), 0.f);
 
-    for (int k = 1; k <= harmonicsCount; ++k) {
-        for (int j = 0; j < constants::WAVETABLE_LENGTH; ++j) {
-            const float phase = 2.f * constants::PI * 1.f * j / constants::WAVETABLE_LENGTH;
-            
-            waveTable[j] += 4.f / constants::PI * std::pow(2.f * k - 1.f, -1.f) * std::sin((2.f * k - 1.f) * phase);
-        }
+    // Every harmonic, with alternating signs and 1/n amplitudes
+    for (int n = 1; n <= lastHarmonic; ++n) {
+        const float sign = (n % 2 == 0) ? 1.f : -1.f;
+        amplitudes[n] = 2.f / constants::PI * sign / static_cast<float>(n);
     }
 
-    return waveTable;
+    return amplitudes;
 }
 
-std::vector<float> WavetableGenerator::generateSawtoothWavetable(int harmonicsCount) {
-    auto waveTable = std::vector<float>(constants::WAVETABLE_LENGTH, 0.f);
+std::vector<float> WavetableGenerator::generateFromHarmonics(const std::vector<float>& amplitudes)
+{
+    jassert(amplitudes.size() <= static_cast<size_t>(getMaxHarmonics() + 1));
 
-    for (int k = 1; k <= harmonicsCount; ++k) {
-        for (int j = 0; j < constants::WAVETABLE_LENGTH; ++j) {
-            const float phase = 2.f * constants::PI * 1.f * j / constants::WAVETABLE_LENGTH;
-            
-            waveTable[j] += 2.f / constants::PI * std::pow(-1.f, k) * std::pow(k, -1.f) * std::sin(k * phase);
-        }
+    // LRN a real-only FFT works on interleaved complex numbers (real, imag); the inverse transform takes
+    //  the first half of the spectrum (bins 0 to N/2) and needs twice the table length of working space
+    juce::dsp::FFT fft(fftOrder);
+    std::vector<float> data(2 * constants::WAVETABLE_LENGTH, 0.f);
+
+    /*
+     A sine of amplitude A at harmonic n is the complex bin -j * A * N / 2 (the inverse transform
+     scales its output by 1 / N), so only the imaginary parts of the spectrum are filled.
+     */
+    const float binScale = 0.5f * static_cast<float>(constants::WAVETABLE_LENGTH);
+
+    for (size_t n = 1; n < amplitudes.size(); ++n) {
+        data[2 * n + 1] = -amplitudes[n] * binScale;
     }
 
-    return waveTable;
+    fft.performRealOnlyInverseTransform(data.data());
+
+    // The table is in the first N values
+    data.resize(constants::WAVETABLE_LENGTH);
+
+    return data;
 }
@@ -16,31 +16,55 @@
  This class contains the necessary functions to generate various wavetables.
  The fuctions in this class are inspired  from here : https://thewolfsound.com/android-synthesizer-6-wavetable-synthesis-in-c-plus-plus/#wavetable-factory
  The wavetables generated are, except for the sine, limited in harmonics to prevent aliasing as much as possible.
- The harmonics limit is set depending on the frequency associated to the MIDI note. Higher frequencies will have less, 
- lower frequencies will have more.
+ The harmonics limit of each table is decided by the WavetableBank, which stores all the generated tables.
+
+ Instead of adding the harmonics one by one in the time domain, the amplitude of each harmonic is written in a
+ spectrum, and the whole table is obtained at once with an inverse FFT.
  */
 class WavetableGenerator
 {
 public:
-    WavetableGenerator();
+    /**
+     Generates a sine wavetable. The same table is also available at compile time in baseWavetables.
+     */
+    static std::vector<float> generateSineWavetable();
+
+    /**
+     Generates a harmonics-limited triangle wavetable. The triangle never goes higher than
+     constants::TRIANGLE_MAX_HARMONIC, even if harmonicsLimit allows it; the full triangle is also available
+     at compile time in baseWavetables.
+     */
+    static std::vector<float> generateTriangleWavetable(int harmonicsLimit);
 
     /**
-     Generates a sine wavetable.
+     Generates a harmonics-limited square wavetable. Only harmonics up to harmonicsLimit (included) are added.
      */
-    std::vector<float> generateSineWavetable();
-    
+    static std::vector<float> generateSquareWavetable(int harmonicsLimit);
+
+    /**
+     Generates a harmonics-limited sawtooth wavetable. Only harmonics up to harmonicsLimit (included) are added.
+     */
+    static std::vector<float> generateSawtoothWavetable(int harmonicsLimit);
+
     /**
-     Generates a triangle wavetable. This triangle waveform has a limit of 10 harmonics.
+     Returns the highest harmonic a wavetable can hold.
      */
-    std::vector<float> generateTriangleWavetable();
-    
+    static constexpr int getMaxHarmonics() { return constants::WAVETABLE_LENGTH / 2 - 1; }
+
     /**
-     Generates a harmonics-limited square wavetable.
+     The amplitudes of the sine harmonics of every shape, up to lastHarmonic (included): element n is the amplitude
+     of harmonic n, and element 0 (DC offset) is always 0. They are the spectra of the wavetables, and the partials of
+     the additive engine.
      */
-    std::vector<float> generateSquareWavetable(int harmonicsCount);
-    
+    static std::vector<float> getSineHarmonics();
+    static std::vector<float> getTriangleHarmonics(int lastHarmonic);
+    static std::vector<float> getSquareHarmonics(int lastHarmonic);
+    static std::vector<float> getSawtoothHarmonics(int lastHarmonic);
+
+private:
     /**
-     Generates a harmonics-limited sawtooth wavetable.
+     Generates a wavetable from the amplitudes of its sine harmonics with an inverse FFT.
+     amplitudes[k] is the amplitude of harmonic k; amplitudes[0] (DC offset) is ignored.
      */
-    std::vector<float> generateSawtoothWavetable(int harmonicsCount);
+    static std::vector<float> generateFromHarmonics(const std::vector<float>& amplitudes);
 };
@@ -9,51 +9,247 @@
 */
 
 #include "WavetableOscillator.h"
-#include <cmath>
+#include "InterpolationPolicies.h"
+#include <algorithm>
 
 // LRN use initializer list for quick and easy constructor
-// LRN std::move declares an object as movable to the compiler; its value becomes an xvalue,
-//  which means its resources can be reused elsewhere. Basically we transfer the content of an
-//  object elsewhere instead of making a copy (super efficient in constructors!)
-WavetableOscillator::WavetableOscillator(std::vector<float> waveTable, float sampleRate) : waveTable{ std::move(waveTable) }, sampleRate{ sampleRate } {}
+// LRN only the pointer is copied here; the samples stay in the bank and are shared by every oscillator
+WavetableOscillator::WavetableOscillator(const WavetableBank::MorphFrames* morphFrames, float sampleRate) : morphFrames{ morphFrames }, sampleRate{ sampleRate } {}
+
+void WavetableOscillator::setMorphFrames(const WavetableBank::MorphFrames* newMorphFrames, float newSampleRate)
+{
+    morphFrames = newMorphFrames;
+    sampleRate = newSampleRate;
+}
+
+void WavetableOscillator::setPhase(uint32_t newPhase)
+{
+    phase = newPhase;
+}
+
+uint32_t WavetableOscillator::getPhase() const
+{
+    return phase;
+}
 
 void WavetableOscillator::setFrequency(float frequency)
 {
-    indexIncrement = frequency * static_cast<float>(waveTable.size()) / sampleRate;
+    // Fraction of a period per sample, in 32-bit fixed point (2^32 is a full period); going through 64 bits
+    //  wraps frequencies over the sample rate around, like the phase itself
+    phaseIncrement = static_cast<uint32_t>(static_cast<int64_t>(static_cast<double>(frequency) / sampleRate * 4294967296.0));
+}
+
+uint32_t WavetableOscillator::getPhaseIncrement() const
+{
+    return phaseIncrement;
 }
 
-float WavetableOscillator::getSample()
+void WavetableOscillator::setMorph(float morph)
 {
-    const float sample = interpolateLinearly();
-    index += indexIncrement;
+    // Get the frame before the morph position, and the position between it and the next frame; the last
+    //  segment goes slightly past the saw (morph 1 is at 1.03 frames after the square), like it always did
+    const float framePosition = std::clamp(morph, 0.0f, 1.0f) / constants::MORPH_FRAME_WIDTH;
+    morphFrame = std::min(static_cast<int>(framePosition), WavetableBank::numShapes - 2);
+    nextMorphFrameWeight = framePosition - static_cast<float>(morphFrame);
+}
+
+void WavetableOscillator::renderBlock(float* out, int numSamples, interpolation::Mode mode)
+{
+    // The mode is checked once per block; each policy has its own loop
+    switch (mode) {
+        case interpolation::truncation:
+            renderBlockWith<interpolation::Truncation>(out, numSamples);
+            break;
+        case interpolation::cubicHermite:
+            renderBlockWith<interpolation::CubicHermite>(out, numSamples);
+            break;
+        case interpolation::lagrange:
+            renderBlockWith<interpolation::Lagrange>(out, numSamples);
+            break;
+        default:
+            renderBlockWith<interpolation::Linear>(out, numSamples);
+            break;
+    }
+}
+
+void WavetableOscillator::renderPastBlock(float* out, int numSamples, int rateDivider, interpolation::Mode mode)
+{
+    const uint32_t savedPhase = phase;
+    const uint32_t savedIncrement = phaseIncrement;
     
-    // After increment, bring back the index to the waveTable size's range
-    index = std::fmod(index, static_cast<float>(waveTable.size()));
+    phaseIncrement /= static_cast<uint32_t>(rateDivider);
+    phase -= static_cast<uint32_t>(numSamples) * phaseIncrement;
+    renderBlock(out, numSamples, mode);
     
-    return sample;
+    phase = savedPhase;
+    phaseIncrement = savedIncrement;
 }
 
-float WavetableOscillator::interpolateLinearly()
+void WavetableOscillator::shiftPhase(double samples)
 {
-    // Get current index and next sample index
-    const int truncatedIndex = static_cast<int>(index);
-    const int nextIndex = (truncatedIndex + 1) % static_cast<int>(waveTable.size());
+    // Through 64 bits, like setFrequency(), so a shift of more than a period wraps around
+    phase += static_cast<uint32_t>(static_cast<int64_t>(samples * static_cast<double>(phaseIncrement)));
+}
+
+template <typename Interpolation>
+void WavetableOscillator::renderBlockWith(float* out, int numSamples)
+{
+    // Everything that doesn't change during the block is read once
+    const WavetableSample* frameTable = (*morphFrames)[morphFrame];
+    const WavetableSample* nextFrameTable = (*morphFrames)[morphFrame + 1];
+    const uint32_t startPhase = phase;
+    const uint32_t increment = phaseIncrement;
     
-    // Calculate weights of both indexes
-    const float nextIndexWeight = index - static_cast<float>(truncatedIndex);
-    const float truncatedIndexWeight = 1.0f - nextIndexWeight;
+    // The phase of each sample is computed from the start of the block rather than accumulated, so the
+    //  iterations don't depend on each other and the loop can be vectorized
+    // LRN unsigned integers wrap around on overflow, which brings the phase back to the start of the period
+    for (int i = 0; i < numSamples; ++i) {
+        out[i] = interpolate<Interpolation>(startPhase + static_cast<uint32_t>(i) * increment, frameTable,
+                                            nextFrameTable, nextMorphFrameWeight);
+    }
     
-    return truncatedIndexWeight * waveTable[truncatedIndex] + nextIndexWeight * waveTable[nextIndex];
+    phase = startPhase + static_cast<uint32_t>(numSamples) * increment;
+}
+
+void WavetableOscillator::renderSyncedBlock(float* out, int numSamples, uint32_t masterPhase, uint32_t masterIncrement,
+                                            interpolation::Mode mode)
+{
+    switch (mode) {
+        case interpolation::truncation:
+            renderSyncedBlockWith<interpolation::Truncation>(out, numSamples, masterPhase, masterIncrement);
+            break;
+        case interpolation::cubicHermite:
+            renderSyncedBlockWith<interpolation::CubicHermite>(out, numSamples, masterPhase, masterIncrement);
+            break;
+        case interpolation::lagrange:
+            renderSyncedBlockWith<interpolation::Lagrange>(out, numSamples, masterPhase, masterIncrement);
+            break;
+        default:
+            renderSyncedBlockWith<interpolation::Linear>(out, numSamples, masterPhase, masterIncrement);
+            break;
+    }
+}
+
+template <typename Interpolation>
+void WavetableOscillator::renderSyncedBlockWith(float* out, int numSamples, uint32_t masterPhase, uint32_t masterIncrement)
+{
+    const WavetableSample* frameTable = (*morphFrames)[morphFrame];
+    const WavetableSample* nextFrameTable = (*morphFrames)[morphFrame + 1];
+    const uint32_t increment = phaseIncrement;
+    const float masterScale = 1.0f / static_cast<float>(std::max(masterIncrement, 1u));
+    
+    const auto read = [&](uint32_t samplePhase) {
+        return interpolate<Interpolation>(samplePhase, frameTable, nextFrameTable, nextMorphFrameWeight);
+    };
+    
+    // Slope of the wave at a phase, per sample, from the table samples on both sides
+    constexpr uint32_t sampleStep { 1u << fractionBits };
+    const float slopeScale = 0.5f * static_cast<float>(increment) * fractionScale;
+    const auto slope = [&](uint32_t samplePhase) {
+        return (read(samplePhase + sampleStep) - read(samplePhase - sampleStep)) * slopeScale;
+    };
+    
+    // Every reset lands on the start of the wave
+    const float resetSample = read(0u);
+    const float resetSlope = slope(0u);
+    
+    uint32_t samplePhase = phase;
+    uint32_t sampleMasterPhase = masterPhase;
+    
+    for (int i = 0; i < numSamples; ++i) {
+        float sample = read(samplePhase) + syncResidual;
+        syncResidual = 0.0f;
+        
+        // The master wraps around before the next sample when its phase overflows; what it went past 0 tells how
+        //  long before the next sample the reset is, in samples
+        const uint32_t nextMasterPhase = sampleMasterPhase + masterIncrement;
+        
+        if (nextMasterPhase < masterIncrement) {
+            const float afterReset = static_cast<float>(nextMasterPhase) * masterScale;
+            const float beforeReset = 1.0f - afterReset;
+            
+            // The wave jumps at the reset, and its slope changes: both are band-limited over this sample and the
+            //  next one, with a PolyBLEP for the jump and a PolyBLAMP for the slope (see PolyBlepOscillator)
+            const uint32_t resetPhase = samplePhase + static_cast<uint32_t>(static_cast<float>(increment) * beforeReset);
+            const float jump = resetSample - read(resetPhase);
+            const float slopeChange = resetSlope - slope(resetPhase);
+            sample += jump * 0.5f * afterReset * afterReset
+                    + slopeChange * (1.0f / 6.0f) * afterReset * afterReset * afterReset;
+            syncResidual = -jump * 0.5f * beforeReset * beforeReset
+                         + slopeChange * (1.0f / 6.0f) * beforeReset * beforeReset * beforeReset;
+            
+            // The wave starts over at the reset, so the next sample is already past its start
+            samplePhase = static_cast<uint32_t>(static_cast<float>(increment) * afterReset);
+        }
+        else {
+            samplePhase += increment;
+        }
+        
+        out[i] = sample;
+        sampleMasterPhase = nextMasterPhase;
+    }
+    
+    phase = samplePhase;
+}
+
+void WavetableOscillator::skipBlock(int numSamples)
+{
+    // The phase wraps around like it does sample by sample
+    phase += static_cast<uint32_t>(numSamples) * phaseIncrement;
+}
+
+void WavetableOscillator::skipSyncedBlock(int numSamples, uint32_t masterPhase, uint32_t masterIncrement)
+{
+    // Same resets as renderSyncedBlockWith(), without reading the tables
+    const float masterScale = 1.0f / static_cast<float>(std::max(masterIncrement, 1u));
+    uint32_t sampleMasterPhase = masterPhase;
+    
+    for (int i = 0; i < numSamples; ++i) {
+        const uint32_t nextMasterPhase = sampleMasterPhase + masterIncrement;
+        
+        if (nextMasterPhase < masterIncrement) {
+            const float afterReset = static_cast<float>(nextMasterPhase) * masterScale;
+            phase = static_cast<uint32_t>(static_cast<float>(phaseIncrement) * afterReset);
+        }
+        else {
+            phase += phaseIncrement;
+        }
+        
+        sampleMasterPhase = nextMasterPhase;
+    }
+    
+    // The correction of a reset is not heard either
+    syncResidual = 0.0f;
+}
+
+void WavetableOscillator::prepareLane(Lane& lane, float* out)
+{
+    lane.oscillator = this;
+    lane.frameTable = (*morphFrames)[morphFrame];
+    lane.nextFrameTable = (*morphFrames)[morphFrame + 1];
+    lane.nextFrameWeight = nextMorphFrameWeight;
+    lane.phase = phase;
+    lane.phaseIncrement = phaseIncrement;
+    lane.output = out;
+    lane.phaseModulation = nullptr;
+    lane.phaseModulationDepth = 0.0f;
+}
+
+void WavetableOscillator::finishLane(const Lane& lane)
+{
+    jassert(lane.oscillator == this);
+    phase = lane.phase;
 }
 
 void WavetableOscillator::stop(bool phaseRand)
 {
     // Starting phase of the oscillator will be randomized on the next note if phaseRand is activated
-    index = (phaseRand ? static_cast<float>(rand() % constants::WAVETABLE_LENGTH) : 0.0f);
-    indexIncrement = 0.0f;
+    phase = (phaseRand ? static_cast<uint32_t>(rand() % constants::WAVETABLE_LENGTH) << fractionBits : 0u);
+    phaseIncrement = 0;
+    syncResidual = 0.0f;
 }
 
 bool WavetableOscillator::isPlaying()
 {
-    return indexIncrement != 0.0f;
+    return phaseIncrement != 0;
 }
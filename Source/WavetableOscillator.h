@@ -10,34 +10,172 @@
 
 #pragma once
 #include <JuceHeader.h>
-#include <vector>
 #include <stdlib.h>
+#include <cstdint>
 #include "Constants.h"
+#include "Interpolation.h"
+#include "WavetableBank.h"
 
 /**
  This class represents a wavetable oscillator. A wavetable oscillator is an oscillator that uses a lookup table
- for its value at each sample point.
+ for its value at each sample point. The oscillator reads a 2D table of morph frames (one per wave shape), so
+ a single oscillator plays any morph between the shapes.
  Inspired from : https://thewolfsound.com/sound-synthesis/wavetable-synth-plugin-in-juce/
  */
 class WavetableOscillator
 {
 public:
     float initFrequency = 0; // Original frequency before modulation
+    
+    // Layout of the phase: the top bits are the table index, the others the fraction between two samples
+    static constexpr int fractionBits { 32 - constants::WAVETABLE_LENGTH_BITS };
+    static constexpr uint32_t fractionMask { (1u << fractionBits) - 1u };
+    static constexpr float fractionScale { 1.0f / static_cast<float>(1u << fractionBits) };
+    
+    /**
+     State of an oscillator for one block, rendered by the SIMD kernels along with other oscillators.
+     */
+    struct Lane
+    {
+        WavetableOscillator* oscillator; // oscillator to give the phase back to
+        const WavetableSample* frameTable;
+        const WavetableSample* nextFrameTable;
+        float nextFrameWeight;
+        uint32_t phase;
+        uint32_t phaseIncrement;
+        float* output;
+        const float* phaseModulation; // added to the phase of every sample, times phaseModulationDepth (only read by
+                                      //  SimdKernels::renderModulatedOscillators)
+        float phaseModulationDepth; // periods per unit of phaseModulation
+    };
 
-    WavetableOscillator(std::vector<float> waveTable, float sampleRate);
+    /**
+     The oscillator reads from morph frames owned by a WavetableBank; the tables are not copied, so the bank must
+     outlive the oscillator.
+     */
+    WavetableOscillator(const WavetableBank::MorphFrames* morphFrames, float sampleRate);
     
     /**
-     Calculates the indexIncrement according to the desired frequency in Hz.
+     Switches to other morph frames and sample rate, keeping the current index. The frequency must be set again
+     after this.
+     */
+    void setMorphFrames(const WavetableBank::MorphFrames* newMorphFrames, float newSampleRate);
+    
+    /**
+     Moves the phase to a position in the period, in 32-bit fixed point (2^32 is a full period).
+     */
+    void setPhase(uint32_t newPhase);
+    
+    /**
+     Returns the position in the period, in 32-bit fixed point.
+     */
+    uint32_t getPhase() const;
+    
+    /**
+     Calculates the phaseIncrement according to the desired frequency in Hz.
      */
     void setFrequency(float frequency);
     
     /**
-     Returns a sample of the oscillator and increments the index.
+     Returns the phase increment per sample, in 32-bit fixed point.
+     */
+    uint32_t getPhaseIncrement() const;
+    
+    /**
+     Sets the morph position, between 0 (sine) and 1 (saw).
+     */
+    void setMorph(float morph);
+    
+    /**
+     Renders the next numSamples samples of the oscillator in out, with an interpolation mode. The synth renders its
+     oscillators with the SIMD kernels instead (this only renders renderPastBlock()); it is the scalar code they
+     replaced, which Benchmarks::reportSimdKernels() checks them against.
+     */
+    void renderBlock(float* out, int numSamples, interpolation::Mode mode);
+    
+    /**
+     Renders in out the numSamples samples the oscillator played up to its current phase at the set frequency divided
+     by rateDivider, without moving the phase: what an oversampled render would have played so far, for a filter
+     that starts on it.
+     */
+    void renderPastBlock(float* out, int numSamples, int rateDivider, interpolation::Mode mode);
+    
+    /**
+     Moves the phase by a number of samples at the set frequency (backwards when negative), in one step.
      */
-    float getSample();
+    void shiftPhase(double samples);
     
     /**
-     Stops playback and resets index/index increment. The starting index can be randomized.
+     Renders the next numSamples samples of the oscillator hard-synced to a master oscillator, which starts the block
+     at masterPhase and moves by masterIncrement every sample: the phase goes back to 0 where the master's phase wraps
+     around, at the exact position between two samples. The jump of the wave at every reset is band-limited with a
+     PolyBLEP residual over the samples on both sides of it; the part of the residual after a reset at the end of
+     the block is added to the first sample of the next one.
+     */
+    void renderSyncedBlock(float* out, int numSamples, uint32_t masterPhase, uint32_t masterIncrement,
+                           interpolation::Mode mode);
+    
+    /**
+     Moves the phase on by numSamples samples at the set frequency without rendering them, for an oscillator that is
+     not heard; it then plays on exactly as if it had rendered them.
+     */
+    void skipBlock(int numSamples);
+    
+    /**
+     Same as skipBlock() for an oscillator hard-synced to a master oscillator, with the resets of renderSyncedBlock().
+     */
+    void skipSyncedBlock(int numSamples, uint32_t masterPhase, uint32_t masterIncrement);
+    
+    /**
+     Fills a lane with the state of the oscillator, so the next block is rendered in out by the SIMD kernels.
+     The morph must be set before this.
+     */
+    void prepareLane(Lane& lane, float* out);
+    
+    /**
+     Takes back the phase of a lane rendered by the SIMD kernels.
+     */
+    void finishLane(const Lane& lane);
+    
+    /**
+     Interpolates between sample points in the morph frames. Reads the frames on both sides of the morph position
+     around samplePhase with the Interpolation policy (see InterpolationPolicies.h), then takes their weighted sum. The
+     indexes around the phase are taken from the phase itself, so they wrap around the table like it does; the
+     index after the last sample is the table's guard sample.
+     */
+    template <typename Interpolation>
+    static float interpolate(uint32_t samplePhase, const WavetableSample* frameTable,
+                             const WavetableSample* nextFrameTable, float nextFrameWeight)
+    {
+        // Index of the sample before the phase, and of its neighbours (only read if the policy needs them)
+        constexpr uint32_t sampleStep { 1u << fractionBits };
+        const uint32_t truncatedIndex = samplePhase >> fractionBits;
+        const uint32_t previousIndex = (samplePhase - sampleStep) >> fractionBits;
+        const uint32_t nextIndex = truncatedIndex + 1;
+        const uint32_t afterNextIndex = ((samplePhase + sampleStep) >> fractionBits) + 1;
+        
+        // Position between the sample before the phase and the next one
+        const float fraction = static_cast<float>(samplePhase & fractionMask) * fractionScale;
+        
+        // The tables may be stored in a 16-bit format; the samples are expanded to float here
+        const float frameSample = Interpolation::interpolate(
+            Interpolation::points == 4 ? WavetableFormat::decode(frameTable[previousIndex]) : 0.0f,
+            WavetableFormat::decode(frameTable[truncatedIndex]),
+            Interpolation::points >= 2 ? WavetableFormat::decode(frameTable[nextIndex]) : 0.0f,
+            Interpolation::points == 4 ? WavetableFormat::decode(frameTable[afterNextIndex]) : 0.0f,
+            fraction);
+        const float nextFrameSample = Interpolation::interpolate(
+            Interpolation::points == 4 ? WavetableFormat::decode(nextFrameTable[previousIndex]) : 0.0f,
+            WavetableFormat::decode(nextFrameTable[truncatedIndex]),
+            Interpolation::points >= 2 ? WavetableFormat::decode(nextFrameTable[nextIndex]) : 0.0f,
+            Interpolation::points == 4 ? WavetableFormat::decode(nextFrameTable[afterNextIndex]) : 0.0f,
+            fraction);
+        
+        return frameSample + (nextFrameSample - frameSample) * nextFrameWeight;
+    }
+    
+    /**
+     Stops playback and resets phase/phase increment. The starting phase can be randomized.
      */
     void stop(bool phaseRand);
     
@@ -47,13 +185,28 @@ public:
     bool isPlaying();
     
 private:
-    std::vector<float> waveTable;
+    const WavetableBank::MorphFrames* morphFrames; // tables of constants::WAVETABLE_LENGTH samples, shared with other oscillators
     float sampleRate;
-    float index = 0.0f;
-    float indexIncrement = 0.0f;
+    
+    // LRN the phase is a 32-bit fixed-point number covering one period: the top bits are the table index and
+    //  the others the fraction between two samples. It wraps around by itself when it overflows, so there is no
+    //  fmod and no drift, and the same notes always give the same samples whatever the block size
+    uint32_t phase = 0;
+    uint32_t phaseIncrement = 0;
+    
+    int morphFrame = 0; // frame before the morph position
+    float nextMorphFrameWeight = 0.0f; // position between morphFrame and the next frame
+    float syncResidual = 0.0f; // hard sync correction of the next sample, after a reset at the end of the last block
+    
+    /**
+     renderBlock() for one interpolation policy.
+     */
+    template <typename Interpolation>
+    void renderBlockWith(float* out, int numSamples);
     
     /**
-     Interpolate between sample points in wavetable. Get weighted sum of the 2 nearest sample points of the index.
+     renderSyncedBlock() for one interpolation policy.
      */
-    float interpolateLinearly();
+    template <typename Interpolation>
+    void renderSyncedBlockWith(float* out, int numSamples, uint32_t masterPhase, uint32_t masterIncrement);
 };